@@ -0,0 +1,196 @@
+#include "Analysis.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "Utilization.h"
+
+using namespace std;
+
+namespace {
+
+// h(t): the work of the jobs released and due in [0, t].
+long long demand(const vector<DemandTask> &tasks, long long t) {
+    long long h = 0;
+    for (const DemandTask &task : tasks) {
+        if (task.d <= t) {
+            h += ((t - task.d) / task.t + 1) * task.c;
+        }
+    }
+    return h;
+}
+
+// The latest absolute deadline before t, 0 if there is none.
+long long deadlineBefore(const vector<DemandTask> &tasks, long long t) {
+    long long latest = 0;
+    for (const DemandTask &task : tasks) {
+        if (task.d < t) {
+            latest = max(latest, (t - 1 - task.d) / task.t * task.t + task.d);
+        }
+    }
+    return latest;
+}
+
+// Whether the spare low utilization covers what the high tasks need beyond
+// their virtual share, in fixed point over periods shortened by shorten.
+bool fmcFits(const vector<Task> &tasks, int shorten) {
+    Utilization uLow, uHighLowMode;
+    for (const Task &t : tasks) {
+        if (t.crit == Low) {
+            uLow += Utilization::ratio(t.lowC, t.period - shorten);
+        } else {
+            uHighLowMode += Utilization::ratio(t.lowC, t.period - shorten);
+        }
+    }
+    Utilization one = Utilization::one();
+    Utilization lamda = uHighLowMode / (one - uLow);
+    Utilization needed;
+    for (const Task &t : tasks) {
+        if (t.crit == High) {
+            Utilization share = Utilization::ratio(t.lowC, t.period - shorten) / uHighLowMode * (one - uLow);
+            needed += max(Utilization(), Utilization::ratio(t.highC, t.period - shorten) - share);
+        }
+    }
+    return lamda <= one && needed <= (one - lamda) * uLow;
+}
+
+}
+
+bool qpaSchedulable(const vector<DemandTask> &tasks) {
+    long double u = 0;
+    long long dMin = LLONG_MAX;
+    long long dMax = 0;
+    long long work = 0;
+    for (const DemandTask &task : tasks) {
+        u += (long double) task.c / task.t;
+        dMin = min(dMin, task.d);
+        dMax = max(dMax, task.d);
+        work += task.c;
+    }
+    if (u > 1) {
+        return false;
+    }
+    // Without deadlines before the period the utilization bound is exact.
+    bool constrained = false;
+    for (const DemandTask &task : tasks) {
+        constrained |= task.d < task.t;
+    }
+    if (!constrained) {
+        return true;
+    }
+
+    // Any deadline missed is missed by L: the first synchronous busy period,
+    // and while U < 1 the bound of Ripoll et al. if that comes first.
+    long long bound = LLONG_MAX;
+    if (u < 1) {
+        long double slack = 0;
+        for (const DemandTask &task : tasks) {
+            slack += (long double) (task.t - task.d) * task.c / task.t;
+        }
+        bound = max(dMax, (long long) (slack / (1 - u)) + 1);
+    }
+    long long busy = work;
+    while (busy < bound) {
+        long long next = 0;
+        for (const DemandTask &task : tasks) {
+            next += (busy + task.t - 1) / task.t * task.c;
+        }
+        if (next == busy) {
+            break;
+        }
+        busy = next;
+    }
+    long long t = deadlineBefore(tasks, min(bound, busy) + 1);
+
+    long long h = demand(tasks, t);
+    while (h <= t && h > dMin) {
+        t = h < t ? h : deadlineBefore(tasks, t);
+        h = demand(tasks, t);
+    }
+    return h <= dMin;
+}
+
+Schedulability analyze(const vector<Task> &tasks, int quantum) {
+    Schedulability s{};
+    // Releases are seen on the next quantum boundary or completion, so a job
+    // may wait up to this long before it can run, its deadline unchanged.
+    int jitter = quantum - 1;
+    Utilization uLow, uHighLowMode;
+    double uLowF = 0, uHighLowModeF = 0, uHighF = 0;
+    bool room = true;
+    vector<DemandTask> worst;
+    for (const Task &t : tasks) {
+        // Utilizations over periods shortened by the jitter bound the demand
+        // of jobs released that late.
+        long long period = t.period - jitter;
+        room &= period > 0;
+        if (t.crit == Low) {
+            uLow += Utilization::ratio(t.lowC, t.period);
+            uLowF += (double) t.lowC / period;
+        } else {
+            uHighLowMode += Utilization::ratio(t.lowC, t.period);
+            uHighLowModeF += (double) t.lowC / period;
+            uHighF += (double) t.highC / period;
+        }
+        worst.push_back(DemandTask{t.crit == Low ? t.lowC : t.highC, period, t.period});
+    }
+    if (!room) {
+        return s;
+    }
+    s.edf = qpaSchedulable(worst);
+
+    Utilization one = Utilization::one();
+    Utilization lamda = uHighLowMode / (one - uLow);
+    vector<DemandTask> lowMode;
+    bool jobsFit = true;
+    for (const Task &t : tasks) {
+        long long deadline = (t.crit == Low ? t.period : lamda.scale(t.period)) - (long long) jitter;
+        // A job released that late cannot run its low WCET before the
+        // virtual deadline, whatever the rest of the set.
+        jobsFit &= deadline >= t.lowC;
+        lowMode.push_back(DemandTask{t.lowC, deadline, t.period});
+    }
+    s.lowMode = jobsFit && uLow + uHighLowMode <= one && qpaSchedulable(lowMode);
+
+    // With deadlines scaled by x, high tasks still fit after the switch.
+    double x = uHighLowModeF / (1 - uLowF);
+    s.edfVd = uLowF + uHighLowModeF <= 1 && x * uLowF + uHighF <= 1;
+
+    // The budgets as the schedulers compute them, then as they would be with
+    // the shortened periods.
+    s.fmc = fmcFits(tasks, 0) && fmcFits(tasks, jitter);
+    s.quantum = quantum;
+    return s;
+}
+
+bool proven(const Schedulability &s, const string &scheduler) {
+    if (scheduler == "EDF") {
+        return true;
+    }
+    return s.quantum == 1 && (scheduler == "EDF-VD" || scheduler == "FMC" || scheduler == "H-FMC");
+}
+
+bool parseAnalysisMode(const string &value, AnalysisMode &mode) {
+    const char *const names[] = {"off", "flag", "skip"};
+    for (int m = AnalysisOff; m <= AnalysisSkip; m++) {
+        if (value == names[m]) {
+            mode = (AnalysisMode) m;
+            return true;
+        }
+    }
+    return false;
+}
+
+Verdict verdict(const Schedulability &s, const string &scheduler) {
+    bool passes;
+    if (scheduler == "EDF") {
+        passes = s.edf;
+    } else if (scheduler == "EDF-VD") {
+        passes = s.lowMode && s.edfVd;
+    } else if (scheduler == "FMC" || scheduler == "H-FMC") {
+        passes = s.lowMode && s.fmc;
+    } else {
+        return Unanalyzed;
+    }
+    return passes ? Passes : Fails;
+}
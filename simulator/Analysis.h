@@ -0,0 +1,81 @@
+#include <string>
+#include <vector>
+
+#include "Task.h"
+
+#ifndef SIMULATOR_ANALYSIS_H
+#define SIMULATOR_ANALYSIS_H
+
+// A sporadic task as demand analysis sees it: cost c every period t, due d
+// after its release.
+struct DemandTask {
+    long long c;
+    long long d;
+    long long t;
+};
+
+// Whether preemptive EDF deciding on every tick meets every deadline of
+// tasks, by Zhang and Burns' Quick Processor-demand Analysis of the demand
+// bound function. Exact for that model.
+bool qpaSchedulable(const std::vector<DemandTask> &tasks);
+
+// Offline schedulability tests of a task set, cheap enough to run on every
+// generated set before simulating it, for schedulers deciding on the
+// boundaries of quantum. Such a scheduler sees a release up to quantum - 1
+// ticks late, which the tests take as release jitter: the demand tests count
+// each job as due that much sooner and the utilization tests use periods that
+// much shorter. A test that passes is meant to guarantee what it says for any
+// execution times up to the WCETs, one that fails only means no guarantee.
+// Only at quantum 1 are the demand tests exact.
+struct Schedulability {
+    // EDF with every job at the WCET of its criticality. Sufficient.
+    bool edf;
+    // Low mode under the virtual deadlines the simulator gives high tasks.
+    // Sufficient.
+    bool lowMode;
+    // Baruah et al.'s EDF-VD test for high tasks across a mode switch, proven
+    // at quantum 1. Above that only simulation backs it: no generated set
+    // passing it and lowMode missed a high deadline at quantum 100.
+    bool edfVd;
+    // Enough spare low task utilization, (1 - lamda) * uLow, to cover what
+    // every high task needs beyond its virtual share once all have switched.
+    // Then FMC's low budget and the drop budget of H-FMC stay non-negative.
+    // Computed in the schedulers' fixed point, with the periods both as they
+    // are and shortened, which like edfVd only simulation backs.
+    bool fmc;
+    // The quantum the set was analyzed for.
+    int quantum;
+};
+
+Schedulability analyze(const std::vector<Task> &tasks, int quantum = 1);
+
+enum Verdict { Unanalyzed, Passes, Fails };
+
+// The test that covers the scheduler of that name: whether it guarantees
+// every high job meets its deadline, or Unanalyzed for RED, SKELETON and
+// FMC_Drop. FMC_Drop holds the jobs of dropped tasks and queues them on the
+// return to low mode with their old deadlines, a backlog none of the tests
+// bound, and which can make a high job miss.
+Verdict verdict(const Schedulability &schedulability, const std::string &scheduler);
+
+// Whether the verdict for the scheduler of that name rests on proven tests
+// alone: EDF's at any quantum, EDF-VD's, FMC's and H-FMC's only at quantum 1,
+// since above it edfVd and fmc are only backed by simulation. Only such
+// verdicts may leave a set out of a scheduler's results.
+bool proven(const Schedulability &schedulability, const std::string &scheduler);
+
+// What a run does with the analysis of every set.
+enum AnalysisMode {
+    // Nothing, and reports no verdicts.
+    AnalysisOff,
+    // Reports per scheduler which sets pass.
+    AnalysisFlag,
+    // Also leaves the sets a scheduler fails on a proven verdict out of its
+    // simulation and its means, and reports how many sets those cover.
+    AnalysisSkip
+};
+
+// Reads "off", "flag" or "skip".
+bool parseAnalysisMode(const std::string &value, AnalysisMode &mode);
+
+#endif //SIMULATOR_ANALYSIS_H
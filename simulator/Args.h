@@ -0,0 +1,39 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef SIMULATOR_ARGS_H
+#define SIMULATOR_ARGS_H
+
+// Parses "value[,value...]" into out, leaving it untouched on error.
+template<typename T>
+bool parseList(const std::string &values, std::vector<T> &out) {
+    std::vector<T> parsed;
+    std::istringstream iss(values);
+    std::string item;
+    while (getline(iss, item, ',')) {
+        std::istringstream itemStream(item);
+        T value;
+        if (!(itemStream >> value) || !itemStream.eof()) {
+            return false;
+        }
+        parsed.push_back(value);
+    }
+    if (parsed.empty()) {
+        return false;
+    }
+    out = parsed;
+    return true;
+}
+
+template<typename T>
+bool parseValue(const std::string &value, T &out) {
+    std::vector<T> parsed;
+    if (!parseList(value, parsed) || parsed.size() != 1) {
+        return false;
+    }
+    out = parsed[0];
+    return true;
+}
+
+#endif //SIMULATOR_ARGS_H
@@ -0,0 +1,308 @@
+#include "Batch.h"
+
+#include <algorithm>
+#include <climits>
+
+#include "TaskMask.h"
+#include "Utilization.h"
+
+using namespace std;
+
+template <int Lanes>
+BatchScheduler<Lanes>::BatchScheduler(bool virtualDeadlines) : virtualDeadlines(virtualDeadlines) {}
+
+template <int Lanes>
+void BatchScheduler<Lanes>::schedule(const vector<const vector<Task>*> &setsIn, int quantumIn,
+                                     const vector<int> &maxTimes) {
+    quantum = quantumIn;
+    start(setsIn, maxTimes);
+    uint32_t live = 0;
+    for (int l = 0; l < Lanes; l++) {
+        live |= (uint32_t) (time[l] <= maxTime[l]) << l;
+    }
+    while (live != 0) {
+        live = step(live);
+    }
+}
+
+template <int Lanes>
+void BatchScheduler<Lanes>::start(const vector<const vector<Task>*> &setsIn, const vector<int> &maxTimes) {
+    taskNum = 0;
+    for (const vector<Task> *set : setsIn) {
+        taskNum = max(taskNum, (int) set->size());
+    }
+    int size = taskNum * Lanes;
+    state.assign(size, Idle);
+    wakeupTime.assign(size, INT_MAX);
+    absoluteDeadline.assign(size, INT_MAX);
+    schedulingDeadline.assign(size, INT_MAX);
+    exeTime.assign(size, 0);
+    need.assign(size, 0);
+    exeNum.assign(size, 0);
+    period.assign(size, 0);
+    virtualPeriod.assign(size, 0);
+    lowC.assign(size, 0);
+    high.assign(size, 0);
+
+    for (int l = 0; l < Lanes; l++) {
+        sets[l] = l < setsIn.size() ? setsIn[l] : nullptr;
+        time[l] = 0;
+        maxTime[l] = l < setsIn.size() ? maxTimes[l] : -1;
+        runningId[l] = -1;
+        mode[l] = 0;
+        counters[l] = Counters{0, 0, 0, 0, 0};
+        if (sets[l] == nullptr) {
+            continue;
+        }
+
+        // lamda as EDFVD computes it, in the schedulers' fixed point.
+        const vector<Task> &tasks = *sets[l];
+        Utilization uLow, uHighLowMode;
+        for (const Task &t : tasks) {
+            if (t.crit == Low) {
+                uLow += Utilization::ratio(t.lowC, t.period);
+            } else {
+                uHighLowMode += Utilization::ratio(t.lowC, t.period);
+            }
+        }
+        Utilization lamda = uHighLowMode / (Utilization::one() - uLow);
+
+        for (int i = 0; i < tasks.size(); i++) {
+            const Task &t = tasks[i];
+            int k = i * Lanes + l;
+            period[k] = t.period;
+            virtualPeriod[k] = virtualDeadlines && t.crit == High ? lamda.scale(t.period) : t.period;
+            lowC[k] = t.lowC;
+            high[k] = t.crit == High;
+            // A sporadic task whose first job arrives later waits for it.
+            wakeupTime[k] = t.firstArrival();
+            absoluteDeadline[k] = wakeupTime[k] + t.period;
+            if (wakeupTime[k] == 0) {
+                release(i, l);
+            }
+        }
+    }
+}
+
+// The phases of EDF::step and of EDFVD's QuantumDecisions::step in their
+// order, each lane at its own time.
+template <int Lanes>
+uint32_t BatchScheduler<Lanes>::step(uint32_t live) {
+    // A lane runs one job at most, whose completion or overrun is its own.
+    for (uint32_t m = live; m != 0; m &= m - 1) {
+        int l = lowestBit(m);
+        counters[l].switches += 2;
+        int id = runningId[l];
+        if (id < 0) {
+            continue;
+        }
+        int k = id * Lanes + l;
+        if (exeTime[k] >= need[k]) {
+            endJob(id, l, true);
+            runningId[l] = -1;
+        } else if (virtualDeadlines && mode[l] == 0 && high[k] && exeTime[k] > lowC[k]) {
+            switchMode(l);
+        }
+    }
+
+    // Misses, releases and the earliest ready deadline of every lane, the
+    // lower id on ties, in one pass: each only looks at its own row.
+    int best[Lanes];
+    int bestDeadline[Lanes];
+    for (int l = 0; l < Lanes; l++) {
+        best[l] = -1;
+        bestDeadline[l] = INT_MAX;
+    }
+    for (int i = 0; i < taskNum; i++) {
+        const int *s = &state[i * Lanes];
+        const int *d = &absoluteDeadline[i * Lanes];
+        const int *w = &wakeupTime[i * Lanes];
+        const int *sd = &schedulingDeadline[i * Lanes];
+        uint32_t late = 0;
+        for (int l = 0; l < Lanes; l++) {
+            late |= (uint32_t) (s[l] != Idle && time[l] > d[l]) << l;
+        }
+        for (late &= live; late != 0; late &= late - 1) {
+            int l = lowestBit(late);
+            if (runningId[l] == i) {
+                runningId[l] = -1;
+            }
+            endJob(i, l, false);
+        }
+
+        uint32_t due = 0;
+        for (int l = 0; l < Lanes; l++) {
+            due |= (uint32_t) (s[l] == Idle && time[l] >= w[l]) << l;
+        }
+        for (due &= live; due != 0; due &= due - 1) {
+            release(i, lowestBit(due));
+        }
+
+        for (int l = 0; l < Lanes; l++) {
+            bool earlier = s[l] == Ready && (best[l] < 0 || sd[l] < bestDeadline[l]);
+            bestDeadline[l] = earlier ? sd[l] : bestDeadline[l];
+            best[l] = earlier ? i : best[l];
+        }
+    }
+    for (uint32_t m = live; m != 0; m &= m - 1) {
+        int l = lowestBit(m);
+        int id = runningId[l];
+        if (best[l] >= 0 && (id < 0 || bestDeadline[l] < schedulingDeadline[id * Lanes + l])) {
+            if (id >= 0) {
+                state[id * Lanes + l] = Ready;
+            }
+            state[best[l] * Lanes + l] = Running;
+            runningId[l] = best[l];
+        }
+        // Back to low mode once the lane idles.
+        if (runningId[l] < 0 && mode[l] > 0) {
+            mode[l] = 0;
+        }
+    }
+
+    // EDF jumps to the next event, for which it needs the earliest ready
+    // deadline and wakeup left; EDF-VD decides on every boundary.
+    int minReady[Lanes];
+    int minWakeup[Lanes];
+    for (int l = 0; l < Lanes; l++) {
+        minReady[l] = minWakeup[l] = INT_MAX;
+    }
+    if (!virtualDeadlines) {
+        for (int i = 0; i < taskNum; i++) {
+            const int *s = &state[i * Lanes];
+            const int *d = &absoluteDeadline[i * Lanes];
+            const int *w = &wakeupTime[i * Lanes];
+            for (int l = 0; l < Lanes; l++) {
+                minReady[l] = min(minReady[l], s[l] == Ready ? d[l] : INT_MAX);
+                minWakeup[l] = min(minWakeup[l], s[l] == Idle ? w[l] : INT_MAX);
+            }
+        }
+    }
+
+    uint32_t next = 0;
+    for (uint32_t m = live; m != 0; m &= m - 1) {
+        int l = lowestBit(m);
+        int t = nextDecision(l, minReady[l], minWakeup[l]);
+        counters[l].switches += 2 * ((t - 1) / quantum - time[l] / quantum);
+        if (runningId[l] >= 0) {
+            exeTime[runningId[l] * Lanes + l] += t - time[l];
+        }
+        time[l] = t;
+        next |= (uint32_t) (t <= maxTime[l]) << l;
+    }
+    return next;
+}
+
+// EDF::nextEvent, or EdfEngine's QuantumDecisions::nextDecision for EDF-VD.
+template <int Lanes>
+int BatchScheduler<Lanes>::nextDecision(int l, int minReady, int minWakeup) const {
+    int t = time[l];
+    int id = runningId[l];
+    int k = id * Lanes + l;
+    if (virtualDeadlines) {
+        long long next = (t / quantum + 1) * (long long) quantum;
+        if (id >= 0) {
+            long long exe = exeTime[k];
+            next = min(next, t + max(1LL, need[k] - exe));
+            if (mode[l] == 0) {
+                next = min(next, t + max(1LL, lowC[k] - exe + 1));
+            }
+            next = min(next, max(t + 1LL, absoluteDeadline[k] + 1LL));
+        }
+        return (int) next;
+    }
+
+    auto boundary = [&](int u) { return (u + quantum - 1) / quantum * quantum; };
+    int next = maxTime[l] + 1;
+    if (id >= 0) {
+        next = min(next, t + max(1, need[k] - exeTime[k]));
+        next = min(next, max(t + 1, absoluteDeadline[k] + 1));
+    }
+    if (minReady != INT_MAX) {
+        next = min(next, boundary(max(t + 1, minReady + 1)));
+    }
+    if (minWakeup != INT_MAX) {
+        next = min(next, boundary(max(t + 1, minWakeup)));
+    }
+    return next;
+}
+
+// In high mode a low job fails as soon as it is released.
+template <int Lanes>
+void BatchScheduler<Lanes>::release(int id, int l) {
+    int k = id * Lanes + l;
+    if (mode[l] > 0 && !high[k]) {
+        endJob(id, l, false);
+        return;
+    }
+    absoluteDeadline[k] = wakeupTime[k] + period[k];
+    int64_t deadline = (int64_t) wakeupTime[k] + (mode[l] == 0 ? virtualPeriod[k] : period[k]);
+    schedulingDeadline[k] = (int) min(deadline, (int64_t) INT_MAX);
+    need[k] = (*sets[l])[id].exeTimes[exeNum[k]];
+    state[k] = Ready;
+}
+
+template <int Lanes>
+void BatchScheduler<Lanes>::endJob(int id, int l, bool success) {
+    const Task &t = (*sets[l])[id];
+    Counters &c = counters[l];
+    if (t.crit == Low) {
+        (success ? c.succeedLow : c.failedLow)++;
+    } else {
+        (success ? c.succeedHigh : c.failedHigh)++;
+    }
+    int k = id * Lanes + l;
+    exeNum[k]++;
+    wakeupTime[k] += t.interArrival(exeNum[k]);
+    exeTime[k] = 0;
+    state[k] = Idle;
+}
+
+// EDF-VD's switch: high jobs get their real deadlines back, low ones fail.
+template <int Lanes>
+void BatchScheduler<Lanes>::switchMode(int l) {
+    mode[l] = 1;
+    for (int i = 0; i < taskNum; i++) {
+        int k = i * Lanes + l;
+        if (state[k] == Idle) {
+            continue;
+        }
+        if (high[k]) {
+            schedulingDeadline[k] = absoluteDeadline[k];
+        } else {
+            endJob(i, l, false);
+        }
+    }
+}
+
+template <int Lanes>
+float BatchScheduler<Lanes>::getLowPFJ(int lane) const {
+    const Counters &c = counters[lane];
+    if (c.succeedLow + c.failedLow == 0) {
+        return 1;
+    }
+    return (float) c.succeedLow / (float) (c.succeedLow + c.failedLow);
+}
+
+template <int Lanes>
+float BatchScheduler<Lanes>::getHighPFJ(int lane) const {
+    const Counters &c = counters[lane];
+    if (c.succeedHigh + c.failedHigh == 0) {
+        return 1;
+    }
+    return (float) c.succeedHigh / (float) (c.succeedHigh + c.failedHigh);
+}
+
+template <int Lanes>
+int BatchScheduler<Lanes>::getContextSwitches(int lane) const {
+    return counters[lane].switches;
+}
+
+template <int Lanes>
+int BatchScheduler<Lanes>::getJobs(int lane) const {
+    const Counters &c = counters[lane];
+    return c.succeedLow + c.failedLow + c.succeedHigh + c.failedHigh;
+}
+
+template class BatchScheduler<8>;
+template class BatchScheduler<16>;
@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <vector>
+
+#include "Task.h"
+
+#ifndef SIMULATOR_BATCH_H
+#define SIMULATOR_BATCH_H
+
+// EDF or EDF-VD over up to Lanes task sets at once, for sweeps of many small
+// sets. The state of task i of every set lies side by side in one row of Lanes
+// values, so each phase of a decision, misses, releases and the pick of the
+// earliest deadline, is one pass over the rows comparing whole rows, and the
+// events a row finds come out as a bitmask of lanes. Those few are then
+// handled lane by lane. Every set keeps its own time and takes exactly the
+// decisions EDF or EDFVD take on it alone, so its PFJs and switches are
+// theirs; sim_check holds them to that. The one departure is a low job
+// running past its low WCET, which taskGen never draws: EDFVD switches mode
+// on it, this does not.
+template <int Lanes>
+class BatchScheduler {
+public:
+    // EDF-VD with virtualDeadlines, EDF without.
+    explicit BatchScheduler(bool virtualDeadlines);
+
+    // Runs sets[l] in lane l up to maxTimes[l], for up to Lanes sets, which
+    // have to outlive the run.
+    void schedule(const std::vector<const std::vector<Task>*> &sets, int quantum, const std::vector<int> &maxTimes);
+
+    float getLowPFJ(int lane) const;
+    float getHighPFJ(int lane) const;
+    int getContextSwitches(int lane) const;
+    int getJobs(int lane) const;
+
+private:
+    enum State { Idle, Ready, Running };
+
+    struct Counters {
+        int failedLow;
+        int succeedLow;
+        int failedHigh;
+        int succeedHigh;
+        int switches;
+    };
+
+    void start(const std::vector<const std::vector<Task>*> &sets, const std::vector<int> &maxTimes);
+    // Takes the next decision of every lane in live, and returns the lanes
+    // still running after it.
+    uint32_t step(uint32_t live);
+    void release(int id, int lane);
+    void endJob(int id, int lane, bool success);
+    void switchMode(int lane);
+    int nextDecision(int lane, int minReady, int minWakeup) const;
+
+    bool virtualDeadlines;
+    int quantum = 1;
+    int taskNum = 0;
+    const std::vector<Task> *sets[Lanes];
+
+    // Row i holds task i of every set, lane l at i * Lanes + l. Sets with
+    // fewer tasks are padded with tasks that never arrive.
+    std::vector<int> state;
+    std::vector<int> wakeupTime;
+    std::vector<int> absoluteDeadline;
+    std::vector<int> schedulingDeadline;
+    std::vector<int> exeTime;
+    // The execution time of the current job, read when it is released.
+    std::vector<int> need;
+    std::vector<int> exeNum;
+    std::vector<int> period;
+    // The virtual relative deadline of high tasks in low mode, the period
+    // otherwise.
+    std::vector<int> virtualPeriod;
+    std::vector<int> lowC;
+    std::vector<int> high;
+
+    int time[Lanes];
+    int maxTime[Lanes];
+    int runningId[Lanes];
+    int mode[Lanes];
+    Counters counters[Lanes];
+};
+
+#endif //SIMULATOR_BATCH_H
@@ -0,0 +1,133 @@
+#include "DeadlineHeap.h"
+
+using namespace std;
+
+void DeadlineHeap::reset(int size) {
+    heap.clear();
+    position.assign(size, -1);
+    deadlines.assign(size, 0);
+}
+
+bool DeadlineHeap::empty() const {
+    return heap.empty();
+}
+
+int DeadlineHeap::size() const {
+    return heap.size();
+}
+
+bool DeadlineHeap::contains(int id) const {
+    return position[id] >= 0;
+}
+
+int DeadlineHeap::top() const {
+    return heap.front();
+}
+
+int DeadlineHeap::topDeadline() const {
+    return deadlines[heap.front()];
+}
+
+int DeadlineHeap::deadline(int id) const {
+    return deadlines[id];
+}
+
+void DeadlineHeap::push(int id, int deadline) {
+    deadlines[id] = deadline;
+    heap.push_back(id);
+    position[id] = (int) heap.size() - 1;
+    up(position[id]);
+}
+
+int DeadlineHeap::pop() {
+    int id = heap.front();
+    erase(id);
+    return id;
+}
+
+void DeadlineHeap::erase(int id) {
+    int pos = position[id];
+    if (pos < 0) {
+        return;
+    }
+    position[id] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if (pos < heap.size()) {
+        place(pos, last);
+        up(pos);
+        down(position[last]);
+    }
+}
+
+void DeadlineHeap::update(int id, int deadline) {
+    deadlines[id] = deadline;
+    if (position[id] >= 0) {
+        up(position[id]);
+        down(position[id]);
+    }
+}
+
+void DeadlineHeap::setDeadline(int id, int deadline) {
+    deadlines[id] = deadline;
+}
+
+void DeadlineHeap::rebuild() {
+    for (int pos = (int) heap.size() / 2 - 1; pos >= 0; pos--) {
+        down(pos);
+    }
+}
+
+bool DeadlineHeap::before(int a, int b) const {
+    return deadlines[a] < deadlines[b] || (deadlines[a] == deadlines[b] && a < b);
+}
+
+void DeadlineHeap::place(int pos, int id) {
+    heap[pos] = id;
+    position[id] = pos;
+}
+
+void DeadlineHeap::up(int pos) {
+    int id = heap[pos];
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (!before(id, heap[parent])) {
+            break;
+        }
+        place(pos, heap[parent]);
+        pos = parent;
+    }
+    place(pos, id);
+}
+
+void DeadlineHeap::down(int pos) {
+    int id = heap[pos];
+    int size = heap.size();
+    while (true) {
+        int child = 2 * pos + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && before(heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!before(heap[child], id)) {
+            break;
+        }
+        place(pos, heap[child]);
+        pos = child;
+    }
+    place(pos, id);
+}
+
+void DeadlineHeap::save(Snapshot &snapshot) const {
+    snapshot.put(heap);
+    snapshot.put(position);
+    snapshot.put(deadlines);
+}
+
+void DeadlineHeap::load(Snapshot &snapshot) {
+    snapshot.get(heap);
+    snapshot.get(position);
+    snapshot.get(deadlines);
+}
@@ -0,0 +1,48 @@
+#include <vector>
+
+#include "Snapshot.h"
+
+#ifndef SIMULATOR_DEADLINEHEAP_H
+#define SIMULATOR_DEADLINEHEAP_H
+
+// Indexed binary min-heap of ready task ids keyed by deadline. Equal deadlines
+// are ordered by the lower id, which is the task the linear scans picked.
+class DeadlineHeap {
+public:
+    void reset(int size);
+
+    // Saves or restores the whole state, see Snapshot.h.
+    void save(Snapshot &snapshot) const;
+    void load(Snapshot &snapshot);
+    bool empty() const;
+    int size() const;
+    bool contains(int id) const;
+
+    int top() const;
+    int topDeadline() const;
+    int deadline(int id) const;
+
+    void push(int id, int deadline);
+    int pop();
+    // Does nothing when id is not in the heap.
+    void erase(int id);
+    // Moves id up or down as needed.
+    void update(int id, int deadline);
+
+    // Bulk re-key: change any number of keys with setDeadline, then restore the
+    // heap once with rebuild in O(n).
+    void setDeadline(int id, int deadline);
+    void rebuild();
+
+private:
+    bool before(int a, int b) const;
+    void place(int pos, int id);
+    void up(int pos);
+    void down(int pos);
+
+    std::vector<int> heap;
+    std::vector<int> position;
+    std::vector<int> deadlines;
+};
+
+#endif //SIMULATOR_DEADLINEHEAP_H
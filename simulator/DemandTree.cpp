@@ -0,0 +1,207 @@
+#include "DemandTree.h"
+
+#include <algorithm>
+#include <climits>
+
+using namespace std;
+
+static const int NONE = INT_MIN / 2;
+
+void DemandTree::reset(int size) {
+    nodes.assign(size, Node{-1, -1, 0, 0, 0, 0, 0, false, false, 0, NONE, 0});
+    root = -1;
+    count = 0;
+    inserted = 0;
+}
+
+bool DemandTree::empty() const {
+    return root < 0;
+}
+
+int DemandTree::size() const {
+    return count;
+}
+
+bool DemandTree::contains(int id) const {
+    return nodes[id].queued;
+}
+
+void DemandTree::insert(int id, int deadline, int demand, int limit, bool low) {
+    unsigned h = (unsigned) inserted * 2654435761u + (unsigned) id * 40503u;
+    h ^= h >> 15;
+    h *= 2246822519u;
+    h ^= h >> 13;
+    nodes[id] = Node{-1, -1, h, deadline, inserted++, demand, limit, low, true, 0, NONE, 0};
+    pull(id);
+    root = insert(root, id);
+    count++;
+}
+
+void DemandTree::erase(int id) {
+    root = erase(root, id);
+    nodes[id].queued = false;
+    count--;
+}
+
+int DemandTree::front() const {
+    int n = root;
+    while (n >= 0 && nodes[n].left >= 0) {
+        n = nodes[n].left;
+    }
+    return n;
+}
+
+int DemandTree::firstOverloaded() const {
+    if (root < 0 || nodes[root].maxExcess <= 0) {
+        return -1;
+    }
+    int n = root;
+    int offset = 0;
+    while (true) {
+        int l = nodes[n].left;
+        if (l >= 0 && offset + nodes[l].maxExcess > 0) {
+            n = l;
+            continue;
+        }
+        if (l >= 0) {
+            offset += nodes[l].sum;
+        }
+        offset += nodes[n].demand;
+        if (offset > nodes[n].limit) {
+            return n;
+        }
+        n = nodes[n].right;
+    }
+}
+
+int DemandTree::lastLowBefore(int id) const {
+    return lastLowBefore(root, id);
+}
+
+bool DemandTree::before(int a, int b) const {
+    return nodes[a].deadline < nodes[b].deadline ||
+           (nodes[a].deadline == nodes[b].deadline && nodes[a].order < nodes[b].order);
+}
+
+void DemandTree::pull(int n) {
+    Node &node = nodes[n];
+    int leftSum = 0;
+    node.maxExcess = NONE;
+    node.lowCount = node.low ? 1 : 0;
+    if (node.left >= 0) {
+        leftSum = nodes[node.left].sum;
+        node.maxExcess = nodes[node.left].maxExcess;
+        node.lowCount += nodes[node.left].lowCount;
+    }
+    node.sum = leftSum + node.demand;
+    node.maxExcess = max(node.maxExcess, node.sum - node.limit);
+    if (node.right >= 0) {
+        node.maxExcess = max(node.maxExcess, node.sum + nodes[node.right].maxExcess);
+        node.sum += nodes[node.right].sum;
+        node.lowCount += nodes[node.right].lowCount;
+    }
+}
+
+void DemandTree::split(int n, int id, int &l, int &r) {
+    if (n < 0) {
+        l = r = -1;
+    } else if (before(n, id)) {
+        split(nodes[n].right, id, nodes[n].right, r);
+        l = n;
+        pull(n);
+    } else {
+        split(nodes[n].left, id, l, nodes[n].left);
+        r = n;
+        pull(n);
+    }
+}
+
+int DemandTree::merge(int l, int r) {
+    if (l < 0 || r < 0) {
+        return l >= 0 ? l : r;
+    }
+    if (nodes[l].priority > nodes[r].priority) {
+        nodes[l].right = merge(nodes[l].right, r);
+        pull(l);
+        return l;
+    }
+    nodes[r].left = merge(l, nodes[r].left);
+    pull(r);
+    return r;
+}
+
+int DemandTree::insert(int n, int id) {
+    if (n < 0) {
+        return id;
+    }
+    if (nodes[id].priority > nodes[n].priority) {
+        split(n, id, nodes[id].left, nodes[id].right);
+        pull(id);
+        return id;
+    }
+    if (before(id, n)) {
+        nodes[n].left = insert(nodes[n].left, id);
+    } else {
+        nodes[n].right = insert(nodes[n].right, id);
+    }
+    pull(n);
+    return n;
+}
+
+int DemandTree::erase(int n, int id) {
+    if (n == id) {
+        return merge(nodes[n].left, nodes[n].right);
+    }
+    if (before(id, n)) {
+        nodes[n].left = erase(nodes[n].left, id);
+    } else {
+        nodes[n].right = erase(nodes[n].right, id);
+    }
+    pull(n);
+    return n;
+}
+
+int DemandTree::lastLowBefore(int n, int id) const {
+    if (n < 0) {
+        return -1;
+    }
+    if (!before(n, id)) {
+        return lastLowBefore(nodes[n].left, id);
+    }
+    int found = lastLowBefore(nodes[n].right, id);
+    if (found >= 0) {
+        return found;
+    }
+    if (nodes[n].low) {
+        return n;
+    }
+    return lastLow(nodes[n].left);
+}
+
+int DemandTree::lastLow(int n) const {
+    while (n >= 0 && nodes[n].lowCount > 0) {
+        int r = nodes[n].right;
+        if (r >= 0 && nodes[r].lowCount > 0) {
+            n = r;
+        } else if (nodes[n].low) {
+            return n;
+        } else {
+            n = nodes[n].left;
+        }
+    }
+    return -1;
+}
+
+void DemandTree::save(Snapshot &snapshot) const {
+    snapshot.put(nodes);
+    snapshot.put(root);
+    snapshot.put(count);
+    snapshot.put(inserted);
+}
+
+void DemandTree::load(Snapshot &snapshot) {
+    snapshot.get(nodes);
+    snapshot.get(root);
+    snapshot.get(count);
+    snapshot.get(inserted);
+}
@@ -0,0 +1,64 @@
+#include <vector>
+
+#include "Snapshot.h"
+
+#ifndef SIMULATOR_DEMANDTREE_H
+#define SIMULATOR_DEMANDTREE_H
+
+// Deadline ordered queue used by RED for admission control. Every entry has a
+// demand and a limit, the cumulative demand of an entry is the sum of the
+// demands up to and including it, and an entry is overloaded when its
+// cumulative demand exceeds its limit. Implemented as a treap indexed by task
+// id whose nodes carry subtree sums, so inserting or removing an entry shifts
+// the cumulative demand of everything behind it without touching those nodes.
+class DemandTree {
+public:
+    void reset(int size);
+
+    // Saves or restores the whole state, see Snapshot.h.
+    void save(Snapshot &snapshot) const;
+    void load(Snapshot &snapshot);
+    bool empty() const;
+    int size() const;
+    bool contains(int id) const;
+
+    // Entries with equal deadlines keep insertion order.
+    void insert(int id, int deadline, int demand, int limit, bool low);
+    void erase(int id);
+
+    int front() const;
+    int firstOverloaded() const;
+    int lastLowBefore(int id) const;
+
+private:
+    struct Node {
+        int left;
+        int right;
+        unsigned priority;
+        int deadline;
+        int order;
+        int demand;
+        int limit;
+        bool low;
+        bool queued;
+        int sum;
+        int maxExcess;
+        int lowCount;
+    };
+
+    bool before(int a, int b) const;
+    void pull(int n);
+    void split(int n, int id, int &l, int &r);
+    int merge(int l, int r);
+    int insert(int n, int id);
+    int erase(int n, int id);
+    int lastLowBefore(int n, int id) const;
+    int lastLow(int n) const;
+
+    std::vector<Node> nodes;
+    int root = -1;
+    int count = 0;
+    int inserted = 0;
+};
+
+#endif //SIMULATOR_DEMANDTREE_H
@@ -0,0 +1,788 @@
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "Scheduler.h"
+#include "TaskMask.h"
+#include "TaskTable.h"
+#include "Utilization.h"
+
+#ifndef SIMULATOR_EDFENGINE_H
+#define SIMULATOR_EDFENGINE_H
+
+// The tick loop shared by EDF-VD, FMC, FMC_Drop and H-FMC. All of them run
+// high tasks on virtual deadlines shrunk by lamda while in low mode; they
+// differ in
+//   Overrun: when a job has overrun its low budget and what a mode switch does,
+//   Drop:    which low tasks stop being scheduled, and for how long,
+//   Timing:  when decisions are taken and how context switches are counted.
+// Each policy is a friend that works on the engine's state, so every
+// instantiation compiles to its own loop with the policies inlined.
+struct UtilizationDrop;
+
+template <class Overrun, class Drop, class Timing>
+class EdfEngine : public Scheduler {
+public:
+    EdfEngine() = default;
+    explicit EdfEngine(const std::vector<Task>& tasksIn) : Scheduler(tasksIn) {}
+    void schedule(int quantum, int maxTime) override;
+    int begin(int quantum, int maxTime) override;
+    int step(int time) override;
+
+protected:
+    void saveState(Snapshot &snapshot) const override;
+    void loadState(Snapshot &snapshot) override;
+    bool steadyState(Snapshot &snapshot, int time) const override;
+
+private:
+    friend Overrun;
+    friend Drop;
+    friend Timing;
+    friend UtilizationDrop;
+
+    enum State { Idle, Ready, Running };
+
+    // What the table does not hold. Times are in table, states in the masks.
+    struct TaskState {
+        int schedulingDeadline;
+        int lowBudget;
+        int exeNum;
+    };
+
+    void start();
+    void setState(int id, State state);
+    bool completes(int id) const;
+    bool overran(int id) const;
+    void completeTask(int id, bool success);
+    void switchMode(int id);
+    bool release(int id);
+    void disable(int id);
+    int dispatch();
+    void returnToLow();
+    void refreshLimits();
+    void missed(int time);
+
+    std::vector<TaskState> taskStates;
+    TaskTable table;
+    // A task is ready when it is neither idle nor running. The running mask
+    // can hold a task that is no longer runningId, dropped while it ran.
+    TaskMask idle;
+    TaskMask running;
+    // Low tasks dropped until the next return to low mode.
+    TaskMask dropped;
+    // Tasks in high mode, running on their real deadlines.
+    TaskMask highMode;
+    TaskMask lowTasks;
+    TaskMask highTasks;
+    // Tasks whose job ran past its limit when limits last changed. Idle tasks
+    // are in it when their limit is negative, as FMC's budget can make it.
+    TaskMask overLimit;
+    // Scratch for the tasks a step works through.
+    TaskMask mask;
+    Overrun overrun;
+    Drop drop;
+    int runningId = -1;
+    int quantum = 1;
+    // Number of tasks in high mode, or 1 while the whole system is.
+    int mode = 0;
+    // Utilizations as the hardware computes them, from each task's C / T.
+    // taskULow is every task's low mode utilization.
+    std::vector<Utilization> taskULow;
+    Utilization uHigh;
+    Utilization uHighLowMode;
+    Utilization uLow;
+    Utilization lamda;
+};
+
+// Overrun policies. overrunAfter is the execution time past which a job has
+// overrun, INT_MAX for never.
+
+// EDF-VD: the whole system switches to high mode as soon as any job runs past
+// its low WCET, and high tasks get their real deadlines back.
+struct SystemOverrun {
+    template <class E> void start(E &) {}
+
+    template <class E> int overrunAfter(const E &e, int id) const {
+        return e.mode == 0 ? e.tasks[id].lowC : INT_MAX;
+    }
+
+    template <class E> int limit(const E &, int) const {
+        return INT_MAX;
+    }
+
+    template <class E> bool switchMode(E &e, int) {
+        e.mode = 1;
+        e.highMode = e.highTasks;
+        e.mask = e.highTasks;
+        e.mask -= e.idle;
+        for (int i = e.mask.first(); i >= 0; i = e.mask.next(i + 1)) {
+            e.taskStates[i].schedulingDeadline = e.table.wakeupTime[i] + e.tasks[i].period;
+            e.readyHeap.setDeadline(i, e.taskStates[i].schedulingDeadline);
+        }
+        e.readyHeap.rebuild();
+        return true;
+    }
+
+    template <class E> void restore(E &) {}
+};
+
+// FMC: only the high task that overran switches, and every low task's budget
+// shrinks with the spare utilization left. Low jobs past their budget fail.
+struct TaskBudgetOverrun {
+    Utilization budget = Utilization::one();
+
+    template <class E> void start(E &) {
+        budget = Utilization::one();
+    }
+
+    template <class E> int overrunAfter(const E &e, int id) const {
+        return e.highMode.contains(id) ? INT_MAX : e.taskStates[id].lowBudget;
+    }
+
+    template <class E> int limit(const E &e, int id) const {
+        return e.highMode.contains(id) ? INT_MAX : e.taskStates[id].lowBudget;
+    }
+
+    template <class E> bool switchMode(E &e, int id) {
+        if (e.tasks[id].crit != High) {
+            return false;
+        }
+        e.mode++;
+        e.highMode.insert(id);
+        e.taskStates[id].schedulingDeadline = e.table.wakeupTime[id] + e.tasks[id].period;
+        Utilization uHighTask = Utilization::ratio(e.tasks[id].highC, e.tasks[id].period);
+        Utilization one = Utilization::one();
+        Utilization newBudget = std::min(Utilization(), ((e.taskULow[id] / e.uHighLowMode) * (one - e.uLow) - uHighTask) / ((one - e.lamda) * e.uLow));
+        budget += newBudget;
+        for (int i = 0; i < e.tasks.size(); i++) {
+            if (e.tasks[i].crit == Low) {
+                e.taskStates[i].lowBudget = budget.scale(e.tasks[i].lowC);
+            }
+        }
+        return true;
+    }
+
+    template <class E> void restore(E &e) {
+        budget = Utilization::one();
+        for (int i = 0; i < e.tasks.size(); i++) {
+            if (e.tasks[i].crit == Low) {
+                e.taskStates[i].lowBudget = e.tasks[i].lowC;
+            }
+        }
+    }
+};
+
+// FMC_Drop and H-FMC: like FMC, but low jobs keep their low WCET as budget.
+struct TaskOverrun {
+    template <class E> void start(E &) {}
+
+    template <class E> int overrunAfter(const E &e, int id) const {
+        return e.highMode.contains(id) ? INT_MAX : e.tasks[id].lowC;
+    }
+
+    template <class E> int limit(const E &e, int id) const {
+        return e.highMode.contains(id) ? INT_MAX : e.tasks[id].lowC;
+    }
+
+    template <class E> bool switchMode(E &e, int id) {
+        if (e.tasks[id].crit != High) {
+            return false;
+        }
+        e.mode++;
+        e.highMode.insert(id);
+        e.taskStates[id].schedulingDeadline = e.table.wakeupTime[id] + e.tasks[id].period;
+        return true;
+    }
+
+    template <class E> void restore(E &) {}
+};
+
+// Drop policies. holdsDropped says whether a released job of a dropped task
+// waits to be enabled again (true) or fails straight away (false).
+
+struct NoDrop {
+    static const bool holdsDropped = false;
+
+    template <class E> void start(E &) {}
+    template <class E> void switchMode(E &, int) {}
+    template <class E> void decide(E &) {}
+    template <class E> void restore(E &) {}
+};
+
+// EDF-VD: every low job fails in high mode.
+struct DropAllLow {
+    static const bool holdsDropped = false;
+
+    template <class E> void start(E &) {}
+
+    template <class E> void switchMode(E &e, int) {
+        STATS(e.stats.dropped += e.lowTasks.count());
+        TRACE(for (int i = e.lowTasks.first(); i >= 0; i = e.lowTasks.next(i + 1)) e.traceEvent(TraceDrop, i));
+        e.dropped = e.lowTasks;
+        e.mask = e.lowTasks;
+        e.mask -= e.idle;
+        for (int i = e.mask.first(); i >= 0; i = e.mask.next(i + 1)) {
+            e.completeTask(i, false);
+        }
+    }
+
+    template <class E> void decide(E &) {}
+    template <class E> void restore(E &) {}
+};
+
+// Each mode switch takes utilization away from the low tasks, which lose the
+// largest ones until the rest fit.
+struct UtilizationDrop {
+    Utilization budget;
+    Utilization curULow;
+
+    template <class E> void start(E &e) {
+        budget = curULow = e.uLow;
+    }
+
+    template <class E> void restore(E &e) {
+        budget = curULow = e.uLow;
+    }
+
+    template <class E> void shrink(const E &e, int id) {
+        Utilization uHighTask = Utilization::ratio(e.tasks[id].highC, e.tasks[id].period);
+        Utilization one = Utilization::one();
+        Utilization newBudget = std::min(Utilization(), ((e.taskULow[id] / e.uHighLowMode) * (one - e.uLow) - uHighTask) / (one - e.lamda));
+        budget += newBudget;
+    }
+
+    bool overBudget() const {
+        return curULow > budget && curULow > Utilization();
+    }
+
+    // Drops the enabled low task with the largest utilization.
+    template <class E> int dropLargest(E &e) {
+        int maxId = -1;
+        Utilization maxU;
+        e.mask = e.lowTasks;
+        e.mask -= e.dropped;
+        for (int i = e.mask.first(); i >= 0; i = e.mask.next(i + 1)) {
+            if (maxId == -1 || e.taskULow[i] > maxU) {
+                maxId = i;
+                maxU = e.taskULow[i];
+            }
+        }
+        e.disable(maxId);
+        curULow -= maxU;
+        return maxId;
+    }
+};
+
+// FMC_Drop: drops all it has to at the mode switch, and jobs of dropped tasks
+// wait until low mode.
+struct DropOnSwitch : UtilizationDrop {
+    static const bool holdsDropped = true;
+
+    template <class E> void switchMode(E &e, int id) {
+        shrink(e, id);
+        while (overBudget()) {
+            if (dropLargest(e) == e.runningId) {
+                e.runningId = -1;
+            }
+        }
+    }
+
+    template <class E> void decide(E &) {}
+};
+
+// H-FMC: drops at most one task per decision, like the hardware does, and
+// jobs of dropped tasks fail.
+struct DropOnePerDecision : UtilizationDrop {
+    static const bool holdsDropped = false;
+
+    template <class E> void switchMode(E &e, int id) {
+        shrink(e, id);
+    }
+
+    template <class E> void decide(E &e) {
+        if (overBudget()) {
+            dropLargest(e);
+        }
+    }
+};
+
+// Timing policies. step takes the decision at time and returns the time of the
+// next one. quantized says whether decisions follow the quantum boundaries.
+
+// Decides on quantum boundaries and whenever the running job completes,
+// overruns or misses, handling every event at once. A decision counts as two
+// context switches. The ticks in between only add to the running job's
+// execution time, so they are skipped.
+struct QuantumDecisions {
+    static const bool quantized = true;
+
+    template <class E> static int step(E &e, int time, int quantum) {
+        e.switches += 2;
+        STATS(e.stats.phase(Complete));
+        TRACE(e.traceTime(time));
+
+        if (e.runningId >= 0 && e.completes(e.runningId)) {
+            e.completeTask(e.runningId, true);
+            e.runningId = -1;
+        }
+
+        if (e.runningId >= 0 && e.overran(e.runningId)) {
+            e.switchMode(e.runningId);
+        }
+
+        STATS(e.stats.phase(Miss));
+        e.missed(time);
+        for (int i = e.mask.first(); i >= 0; i = e.mask.next(i + 1)) {
+            e.completeTask(i, false);
+            if (i == e.runningId) {
+                e.runningId = -1;
+            }
+        }
+        e.drop.decide(e);
+
+        STATS(e.stats.phase(Release));
+        e.table.advance(time, e.idle);
+        const TaskMask &due = e.table.due();
+        for (int i = due.first(); i >= 0; i = due.next(i + 1)) {
+            e.release(i);
+        }
+
+        // A task dropped while it was running gives the processor up.
+        if (e.runningId >= 0 && e.dropped.contains(e.runningId)) {
+            e.setState(e.runningId, E::Ready);
+            e.runningId = -1;
+        }
+
+        STATS(e.stats.phase(Dispatch));
+        STATS(e.stats.sampleQueue(e.readyHeap.size()));
+        e.dispatch();
+
+        if (e.runningId == -1 && e.mode > 0) {
+            e.returnToLow();
+        }
+        STATS(e.stats.phase(Advance));
+
+        int next = nextDecision(e, time, quantum);
+        if (e.runningId >= 0) {
+            e.table.exeTime[e.runningId] += next - time;
+        }
+        return next;
+    }
+
+    // The next quantum boundary, or the tick on which the running job, one
+    // tick of execution further each tick, completes, overruns or misses.
+    template <class E> static int nextDecision(const E &e, int time, int quantum) {
+        long long next = (time / quantum + 1) * (long long) quantum;
+        int id = e.runningId;
+        if (id >= 0) {
+            long long exeTime = e.table.exeTime[id];
+            long long remaining = e.tasks[id].exeTimes[e.taskStates[id].exeNum] - exeTime;
+            next = std::min(next, time + std::max(1LL, remaining));
+            next = std::min(next, time + std::max(1LL, e.overrun.overrunAfter(e, id) - exeTime + 1));
+            next = std::min(next, std::max(time + 1LL, e.table.absoluteDeadline[id] + 1LL));
+        }
+        return (int) next;
+    }
+};
+
+// Decides on every clock in the order of the hardware in
+// scheduler/verilog: a mode switch, then one completion or miss, one drop and
+// one release. Only real preemptions and dispatches count as switches.
+struct ClockDecisions {
+    static const bool quantized = false;
+
+    template <class E> static int step(E &e, int time, int) {
+        STATS(e.stats.phase(Complete));
+        TRACE(e.traceTime(time));
+
+        if (e.runningId >= 0 && e.overran(e.runningId)) {
+            e.switchMode(e.runningId);
+        }
+
+        if (e.runningId >= 0 && e.completes(e.runningId)) {
+            e.completeTask(e.runningId, true);
+            e.runningId = -1;
+        } else {
+            STATS(e.stats.phase(Miss));
+            e.missed(time);
+            int i = e.mask.first();
+            if (i >= 0) {
+                e.completeTask(i, false);
+                if (i == e.runningId) {
+                    e.switches++;
+                    e.runningId = -1;
+                }
+            }
+        }
+        e.drop.decide(e);
+
+        STATS(e.stats.phase(Release));
+        e.table.advance(time, e.idle);
+        const TaskMask &due = e.table.due();
+        for (int i = due.first(); i >= 0 && !e.release(i); i = due.next(i + 1)) {}
+
+        STATS(e.stats.phase(Dispatch));
+        STATS(e.stats.sampleQueue(e.readyHeap.size()));
+        e.switches += e.dispatch();
+
+        if (e.runningId == -1 && e.mode > 0) {
+            e.returnToLow();
+        }
+        STATS(e.stats.phase(Advance));
+        if (e.runningId >= 0) {
+            e.table.exeTime[e.runningId]++;
+        }
+        return time + 1;
+    }
+};
+
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::schedule(int quantum, int maxTime) {
+    for (int time = begin(quantum, maxTime); time <= maxTime; time = EdfEngine::step(time)) {}
+    finish();
+}
+
+template <class Overrun, class Drop, class Timing>
+int EdfEngine<Overrun, Drop, Timing>::begin(int quantumIn, int) {
+    start();
+    quantum = quantumIn;
+    return 0;
+}
+
+template <class Overrun, class Drop, class Timing>
+int EdfEngine<Overrun, Drop, Timing>::step(int time) {
+    return Timing::step(*this, time, quantum);
+}
+
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::start() {
+    runningId = -1;
+    mode = 0;
+    uHigh = uHighLowMode = uLow = Utilization();
+
+    taskStates.clear();
+    taskULow.clear();
+    table.reset(tasks.size());
+    for (TaskMask *m : {&idle, &running, &dropped, &highMode, &lowTasks, &highTasks, &overLimit, &mask}) {
+        m->reset(tasks.size());
+    }
+    for (int i = 0; i < tasks.size(); i++) {
+        const Task& t = tasks[i];
+        taskStates.emplace_back(TaskState {t.period, t.lowC, 0});
+        if (t.crit == Low) {
+            lowTasks.insert(i);
+        } else {
+            highTasks.insert(i);
+        }
+        // A sporadic task whose first job arrives later starts idle.
+        table.wakeupTime[i] = t.firstArrival();
+        table.absoluteDeadline[i] = table.wakeupTime[i] + t.period;
+        table.exeTime[i] = 0;
+        if (table.wakeupTime[i] > 0) {
+            idle.insert(i);
+            table.sleep(i);
+        } else {
+            table.wake(i);
+        }
+        taskULow.push_back(Utilization::ratio(t.lowC, t.period));
+        if (t.crit == Low) {
+            uLow += taskULow[i];
+        } else {
+            uHighLowMode += taskULow[i];
+            uHigh += Utilization::ratio(t.highC, t.period);
+        }
+    }
+
+    lamda = uHighLowMode / (Utilization::one() - uLow);
+
+    readyHeap.reset(tasks.size());
+    TRACE(traceTime(0));
+    for (int i = 0; i < tasks.size(); i++) {
+        if (idle.contains(i)) {
+            continue;
+        }
+        if (tasks[i].crit == High) {
+            taskStates[i].schedulingDeadline = lamda.scale(tasks[i].period);
+        }
+        readyHeap.push(i, taskStates[i].schedulingDeadline);
+        TRACE(traceEvent(TraceRelease, i));
+    }
+
+    reset();
+    overrun.start(*this);
+    drop.start(*this);
+    refreshLimits();
+}
+
+// Everything but the scratch mask. The policies are plain values.
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::saveState(Snapshot &snapshot) const {
+    Scheduler::saveState(snapshot);
+    snapshot.put(taskStates);
+    table.save(snapshot);
+    for (const TaskMask *m : {&idle, &running, &dropped, &highMode, &lowTasks, &highTasks, &overLimit}) {
+        m->save(snapshot);
+    }
+    snapshot.put(overrun);
+    snapshot.put(drop);
+    snapshot.put(runningId);
+    snapshot.put(mode);
+    snapshot.put(taskULow);
+    snapshot.put(uHigh);
+    snapshot.put(uHighLowMode);
+    snapshot.put(uLow);
+    snapshot.put(lamda);
+}
+
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::loadState(Snapshot &snapshot) {
+    Scheduler::loadState(snapshot);
+    snapshot.get(taskStates);
+    table.load(snapshot);
+    for (TaskMask *m : {&idle, &running, &dropped, &highMode, &lowTasks, &highTasks, &overLimit}) {
+        m->load(snapshot);
+    }
+    snapshot.get(overrun);
+    snapshot.get(drop);
+    snapshot.get(runningId);
+    snapshot.get(mode);
+    snapshot.get(taskULow);
+    snapshot.get(uHigh);
+    snapshot.get(uHighLowMode);
+    snapshot.get(uLow);
+    snapshot.get(lamda);
+}
+
+// Timers that fire are checked against the table, so the wheel adds nothing
+// to its times. The scratch mask is set before every use.
+template <class Overrun, class Drop, class Timing>
+bool EdfEngine<Overrun, Drop, Timing>::steadyState(Snapshot &snapshot, int time) const {
+    if (Timing::quantized) {
+        snapshot.put(time % quantum);
+    }
+    for (const TaskMask *m : {&idle, &running, &dropped, &highMode, &overLimit, &table.due(), &table.late()}) {
+        m->save(snapshot);
+    }
+    snapshot.put(overrun);
+    snapshot.put(drop);
+    snapshot.put(runningId);
+    snapshot.put(mode);
+    for (int i = 0; i < tasks.size(); i++) {
+        snapshot.put(table.wakeupTime[i] - time);
+        snapshot.put(table.absoluteDeadline[i] - time);
+        snapshot.put(table.exeTime[i]);
+        snapshot.put(table.limit[i]);
+        snapshot.put(taskStates[i].schedulingDeadline - time);
+        snapshot.put(taskStates[i].lowBudget);
+        snapshot.put(readyHeap.contains(i) ? readyHeap.deadline(i) - time : INT_MIN);
+    }
+    return true;
+}
+
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::setState(int id, State state) {
+    if (state != Idle && idle.contains(id)) {
+        table.wake(id);
+    }
+    if (state == Idle) {
+        idle.insert(id);
+    } else {
+        idle.erase(id);
+    }
+    if (state == Running) {
+        running.insert(id);
+    } else {
+        running.erase(id);
+    }
+}
+
+template <class Overrun, class Drop, class Timing>
+bool EdfEngine<Overrun, Drop, Timing>::completes(int id) const {
+    return table.exeTime[id] >= tasks[id].exeTimes[taskStates[id].exeNum];
+}
+
+template <class Overrun, class Drop, class Timing>
+bool EdfEngine<Overrun, Drop, Timing>::overran(int id) const {
+    return table.exeTime[id] > overrun.overrunAfter(*this, id);
+}
+
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::completeTask(int id, bool success) {
+    if (success) {
+        if (tasks[id].crit == Low) {
+            succeedLow++;
+        } else {
+            succeedHigh++;
+        }
+    } else {
+        if (tasks[id].crit == Low) {
+            failedLow++;
+        } else {
+            failedHigh++;
+        }
+    }
+    TRACE(traceEvent(success ? TraceComplete : TraceMiss, id));
+    readyHeap.erase(id);
+    taskStates[id].exeNum++;
+    setState(id, Idle);
+    table.wakeupTime[id] += tasks[id].interArrival(taskStates[id].exeNum);
+    table.exeTime[id] = 0;
+    table.sleep(id);
+    if (table.exeTime[id] <= table.limit[id]) {
+        overLimit.erase(id);
+    }
+}
+
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::switchMode(int id) {
+    if (overrun.switchMode(*this, id)) {
+        STATS(stats.modeSwitches++);
+        TRACE(traceEvent(TraceModeSwitch, id));
+        drop.switchMode(*this, id);
+        refreshLimits();
+    }
+}
+
+// Returns whether the job became ready to be dispatched.
+template <class Overrun, class Drop, class Timing>
+bool EdfEngine<Overrun, Drop, Timing>::release(int id) {
+    TRACE(traceEvent(TraceRelease, id));
+    if (dropped.contains(id) && !Drop::holdsDropped) {
+        completeTask(id, false);
+        return false;
+    }
+    if (tasks[id].crit == High && !highMode.contains(id)) {
+        // A saturated lamda leaves the virtual deadline at the end of time.
+        int64_t deadline = (int64_t) table.wakeupTime[id] + lamda.scale(tasks[id].period);
+        taskStates[id].schedulingDeadline = (int) std::min(deadline, (int64_t) INT_MAX);
+    } else {
+        taskStates[id].schedulingDeadline = table.wakeupTime[id] + tasks[id].period;
+    }
+    table.absoluteDeadline[id] = table.wakeupTime[id] + tasks[id].period;
+    setState(id, Ready);
+    if (dropped.contains(id)) {
+        return false;
+    }
+    readyHeap.push(id, taskStates[id].schedulingDeadline);
+    return true;
+}
+
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::disable(int id) {
+    dropped.insert(id);
+    STATS(stats.dropped++);
+    TRACE(traceEvent(TraceDrop, id));
+    readyHeap.erase(id);
+}
+
+// Preempts the running task if the heap has an earlier deadline. Returns the
+// number of context switches done.
+template <class Overrun, class Drop, class Timing>
+int EdfEngine<Overrun, Drop, Timing>::dispatch() {
+    if (readyHeap.empty() ||
+        (runningId >= 0 && readyHeap.topDeadline() >= taskStates[runningId].schedulingDeadline)) {
+        return 0;
+    }
+    int done = 1;
+    if (runningId >= 0) {
+        TRACE(traceEvent(TracePreempt, runningId));
+        setState(runningId, Ready);
+        if (!dropped.contains(runningId)) {
+            readyHeap.push(runningId, taskStates[runningId].schedulingDeadline);
+        }
+        done++;
+    }
+    runningId = readyHeap.pop();
+    setState(runningId, Running);
+    TRACE(traceEvent(TraceDispatch, runningId));
+    return done;
+}
+
+// Back to low mode once the processor idles: dropped tasks are enabled again
+// and their waiting jobs queued.
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::returnToLow() {
+    TRACE(traceEvent(TraceModeSwitch, -1));
+    mode = 0;
+    overrun.restore(*this);
+    drop.restore(*this);
+    // Only dropped tasks can have ready jobs outside the heap.
+    mask = dropped;
+    mask -= idle;
+    mask -= running;
+    for (int i = mask.first(); i >= 0; i = mask.next(i + 1)) {
+        if (!readyHeap.contains(i)) {
+            readyHeap.push(i, taskStates[i].schedulingDeadline);
+        }
+    }
+    STATS(stats.reenabled += dropped.count());
+    dropped.clear();
+    highMode.clear();
+    refreshLimits();
+    if (!readyHeap.empty()) {
+        runningId = readyHeap.pop();
+        setState(runningId, Running);
+        TRACE(traceEvent(TraceDispatch, runningId));
+    }
+}
+
+// Limits only change with modes, so they are recomputed on mode changes
+// rather than checked on every decision. Between changes only the running job
+// can pass its limit.
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::refreshLimits() {
+    overLimit.clear();
+    for (int i = 0; i < tasks.size(); i++) {
+        table.limit[i] = overrun.limit(*this, i);
+        if (table.exeTime[i] > table.limit[i]) {
+            overLimit.insert(i);
+        }
+    }
+}
+
+// Sets mask to the tasks not idle that missed their deadline or ran past
+// their limit.
+template <class Overrun, class Drop, class Timing>
+void EdfEngine<Overrun, Drop, Timing>::missed(int time) {
+    table.advance(time, idle);
+    const TaskMask &late = table.late();
+    for (int w = 0; w < mask.words(); w++) {
+        mask.setWord(w, (late.word(w) | overLimit.word(w)) & ~idle.word(w));
+    }
+    if (runningId >= 0 && table.exeTime[runningId] > table.limit[runningId]) {
+        mask.insert(runningId);
+    }
+}
+
+// The schedulers are instantiated once, in their own source files.
+
+class EDFVD : public EdfEngine<SystemOverrun, DropAllLow, QuantumDecisions> {
+public:
+    EDFVD();
+    explicit EDFVD(const std::vector<Task>& tasksIn);
+};
+
+class FMC : public EdfEngine<TaskBudgetOverrun, NoDrop, QuantumDecisions> {
+public:
+    FMC();
+    explicit FMC(const std::vector<Task>& tasksIn);
+};
+
+class FMC_Drop : public EdfEngine<TaskOverrun, DropOnSwitch, QuantumDecisions> {
+public:
+    FMC_Drop();
+    explicit FMC_Drop(const std::vector<Task>& tasksIn);
+};
+
+class H_FMC : public EdfEngine<TaskOverrun, DropOnePerDecision, ClockDecisions> {
+public:
+    H_FMC();
+    explicit H_FMC(const std::vector<Task>& tasksIn);
+};
+
+extern template class EdfEngine<SystemOverrun, DropAllLow, QuantumDecisions>;
+extern template class EdfEngine<TaskBudgetOverrun, NoDrop, QuantumDecisions>;
+extern template class EdfEngine<TaskOverrun, DropOnSwitch, QuantumDecisions>;
+extern template class EdfEngine<TaskOverrun, DropOnePerDecision, ClockDecisions>;
+
+#endif //SIMULATOR_EDFENGINE_H
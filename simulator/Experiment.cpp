@@ -0,0 +1,79 @@
+#include "Experiment.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace std;
+
+vector<Scheduler*> makeSchedulers(int coreNum, Packing packing, int threadNum, bool skeleton) {
+    vector<Scheduler*> schedulers;
+    if (coreNum > 1) {
+        for (const function<Scheduler*()> &make : vector<function<Scheduler*()>>{
+                [] { return new H_FMC(); }, [] { return new EDF(); }, [] { return new EDFVD(); },
+                [] { return new FMC(); }, [] { return new FMC_Drop(); }, [] { return new RED(); }}) {
+            schedulers.push_back(new Partitioned(make, coreNum, packing, threadNum));
+        }
+        schedulers.push_back(new GlobalEDFVD(coreNum));
+        return schedulers;
+    }
+    schedulers.push_back(new H_FMC());
+    schedulers.push_back(new EDF());
+    schedulers.push_back(new EDFVD());
+    schedulers.push_back(new FMC());
+    schedulers.push_back(new FMC_Drop());
+    schedulers.push_back(new RED());
+    if (skeleton) {
+        schedulers.push_back(new Skeleton());
+    }
+    return schedulers;
+}
+
+double switchRatio(const Result &r, const Result &base) {
+    return (double) r.switches * base.ticks / ((double) base.switches * r.ticks);
+}
+
+void runAll(const vector<unique_ptr<TaskSet>> &taskSets, int schedulerNum, int threadNum,
+            vector<vector<Result>> &results, const vector<vector<bool>> &skip, const RunOptions &options) {
+    atomic<int> next(0);
+    int jobNum = taskSets.size() * schedulerNum;
+    results.assign(taskSets.size(), vector<Result>(schedulerNum, Result{0, 0, 0, false, 0, 0, 0, 0, {}}));
+
+    // Threads the pairs leave idle go to the cores of partitioned ones.
+    int coreThreads = max(1, threadNum / max(1, jobNum));
+    auto worker = [&]() {
+        // A scheduler holds the state of the run it is doing.
+        vector<Scheduler*> schedulers = makeSchedulers(options.cores, options.packing, coreThreads, options.skeleton);
+        for (int job = next++; job < jobNum; job = next++) {
+            if (!skip.empty() && skip[job / schedulerNum][job % schedulerNum]) {
+                continue;
+            }
+            const TaskSet &taskSet = *taskSets[job / schedulerNum];
+            Scheduler* sch = schedulers[job % schedulerNum];
+            sch->reset(taskSet.tasks);
+            Convergence c{taskSet.clockPeriods + 1, 0, 0};
+            if (options.precision > 0 || options.jobBudget > 0) {
+                c = sch->scheduleConverged(RUN_QUANTUM, taskSet.clockPeriods, options.precision, options.jobBudget);
+            } else if (options.steady) {
+                sch->scheduleSteady(RUN_QUANTUM, taskSet.clockPeriods);
+            } else {
+                sch->schedule(RUN_QUANTUM, taskSet.clockPeriods);
+            }
+            results[job / schedulerNum][job % schedulerNum] =
+                    Result{sch->getLowPFJ(), sch->getHighPFJ(), sch->getContextSwitches(), true, c.ticks,
+                           c.lowHalfWidth, c.highHalfWidth, sch->getMigrations(), sch->getCoreUtilizations()};
+        }
+        for (Scheduler* sch : schedulers) {
+            delete sch;
+        }
+    };
+
+    vector<thread> threads;
+    for (int i = 1; i < threadNum; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (thread &t : threads) {
+        t.join();
+    }
+}
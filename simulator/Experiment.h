@@ -0,0 +1,70 @@
+#include <memory>
+#include <vector>
+
+#include "EdfEngine.h"
+#include "Partition.h"
+#include "Scheduler.h"
+#include "TaskSet.h"
+
+#ifndef SIMULATOR_EXPERIMENT_H
+#define SIMULATOR_EXPERIMENT_H
+
+struct Result {
+    float lowPFJ;
+    float highPFJ;
+    int switches;
+    // False for a pair runAll was told to skip, whose other fields are 0.
+    bool simulated;
+    // Ticks simulated, fewer than the set's clockPeriods + 1 when the run
+    // stopped early, and the intervals it stopped on (see Convergence).
+    int ticks;
+    float lowHalfWidth;
+    float highHalfWidth;
+    // See Scheduler::getMigrations and getCoreUtilizations.
+    int migrations;
+    std::vector<float> coreUtilizations;
+};
+
+// The quantum runAll schedules with.
+const int RUN_QUANTUM = 100;
+
+// How runAll runs every pair.
+struct RunOptions {
+    // With Scheduler::scheduleSteady.
+    bool steady = false;
+    // With Scheduler::scheduleConverged when either is set, which then takes
+    // precedence over steady.
+    float precision = 0;
+    int jobBudget = 0;
+    // Partitioned onto this many cores.
+    int cores = 1;
+    Packing packing = FirstFit;
+    // Adds SKELETON on one core, see makeSchedulers.
+    bool skeleton = false;
+};
+
+// The switches of r relative to those of base, per tick so runs that stopped
+// at different times compare. G-EDF-VD charges every core on every boundary,
+// idle or not, so its ratios only compare with runs on as many cores.
+double switchRatio(const Result &r, const Result &base);
+
+// The schedulers every experiment compares, in report order. Switch ratios
+// are relative to the first one. On more than one core they are Partitioned
+// ones, each running up to threadNum cores at once, followed by GlobalEDFVD.
+// skeleton adds SKELETON last on one core only, as it models a single
+// hardware scheduler and simulates every clock, several times slower than
+// the others together.
+std::vector<Scheduler*> makeSchedulers(int coreNum = 1, Packing packing = FirstFit, int threadNum = 1,
+                                       bool skeleton = false);
+
+// Runs every (task set, scheduler) pair, for the first schedulerNum schedulers
+// of makeSchedulers for options.cores, on threadNum threads, each thread
+// taking the next pair as soon as it is done with its last one and using its
+// own scheduler instances. results[set][scheduler] does not depend on the
+// number of threads. Pairs with skip[set][scheduler] set are not run, skip
+// may be empty.
+void runAll(const std::vector<std::unique_ptr<TaskSet>> &taskSets, int schedulerNum, int threadNum,
+            std::vector<std::vector<Result>> &results, const std::vector<std::vector<bool>> &skip = {},
+            const RunOptions &options = RunOptions());
+
+#endif //SIMULATOR_EXPERIMENT_H
@@ -0,0 +1,164 @@
+#include "Partition.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <thread>
+
+using namespace std;
+
+bool parsePacking(const string &value, Packing &packing) {
+    const char *const names[] = {"first", "worst", "criticality"};
+    for (int p = FirstFit; p <= CriticalityDecreasing; p++) {
+        if (value == names[p]) {
+            packing = (Packing) p;
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<int> pack(const vector<Task> &tasks, int coreNum, Packing packing) {
+    vector<int> order(tasks.size());
+    for (int i = 0; i < tasks.size(); i++) {
+        order[i] = i;
+    }
+    auto uLow = [&](int i) { return (double) tasks[i].lowC / tasks[i].period; };
+    auto uHigh = [&](int i) { return tasks[i].crit == High ? (double) tasks[i].highC / tasks[i].period : 0; };
+    if (packing == CriticalityDecreasing) {
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            if (tasks[a].crit != tasks[b].crit) {
+                return tasks[a].crit == High;
+            }
+            return tasks[a].crit == High ? uHigh(a) > uHigh(b) : uLow(a) > uLow(b);
+        });
+    }
+
+    vector<double> coreLow(coreNum, 0), coreHigh(coreNum, 0);
+    vector<int> coreOf(tasks.size());
+    for (int i : order) {
+        int core = -1;
+        for (int c = 0; c < coreNum; c++) {
+            if (coreLow[c] + uLow(i) > 1 || coreHigh[c] + uHigh(i) > 1) {
+                continue;
+            }
+            if (core < 0 || (packing == WorstFit && coreLow[c] < coreLow[core])) {
+                core = c;
+            }
+            if (packing != WorstFit) {
+                break;
+            }
+        }
+        if (core < 0) {
+            core = (int) (min_element(coreLow.begin(), coreLow.end()) - coreLow.begin());
+        }
+        coreOf[i] = core;
+        coreLow[core] += uLow(i);
+        coreHigh[core] += uHigh(i);
+    }
+    return coreOf;
+}
+
+Partitioned::Partitioned(const function<Scheduler*()> &make, int coreNum, Packing packing, int threadNum)
+        : packing(packing), threadNum(threadNum) {
+    for (int c = 0; c < coreNum; c++) {
+        cores.emplace_back(make());
+    }
+    name = "P-" + cores[0]->getName();
+    partitions.resize(coreNum);
+}
+
+void Partitioned::reset(const vector<Task> &tasksIn) {
+    Scheduler::reset(tasksIn);
+    vector<int> coreOf = pack(tasks, cores.size(), packing);
+    for (vector<Task> &partition : partitions) {
+        partition.clear();
+    }
+    for (int i = 0; i < tasks.size(); i++) {
+        partitions[coreOf[i]].push_back(tasks[i]);
+    }
+    for (int c = 0; c < cores.size(); c++) {
+        cores[c]->reset(partitions[c]);
+    }
+}
+
+// Cores without tasks are left out of the run.
+void Partitioned::schedule(int quantumIn, int maxTimeIn) {
+    Scheduler::reset();
+    atomic<int> nextCore(0);
+    auto worker = [&]() {
+        for (int c = nextCore++; c < cores.size(); c = nextCore++) {
+            if (!partitions[c].empty()) {
+                cores[c]->schedule(quantumIn, maxTimeIn);
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (int i = 1; i < min<int>(threadNum, cores.size()); i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (thread &t : threads) {
+        t.join();
+    }
+    sumCounters(cores);
+    Scheduler::finish();
+}
+
+int Partitioned::begin(int quantumIn, int maxTimeIn) {
+    quantum = quantumIn;
+    maxTime = maxTimeIn;
+    Scheduler::reset();
+    next.assign(cores.size(), INT_MAX);
+    for (int c = 0; c < cores.size(); c++) {
+        if (!partitions[c].empty()) {
+            next[c] = cores[c]->begin(quantum, maxTime);
+        }
+    }
+    sumCounters(cores);
+    return *min_element(next.begin(), next.end());
+}
+
+int Partitioned::step(int time) {
+    for (int c = 0; c < cores.size(); c++) {
+        if (next[c] == time) {
+            next[c] = cores[c]->step(time);
+        }
+    }
+    sumCounters(cores);
+    return *min_element(next.begin(), next.end());
+}
+
+void Partitioned::finish() {
+    for (int c = 0; c < cores.size(); c++) {
+        if (!partitions[c].empty()) {
+            cores[c]->finish();
+        }
+    }
+    Scheduler::finish();
+}
+
+// Every core is saved as a snapshot of its own, at its own next decision.
+void Partitioned::saveState(Snapshot &snapshot) const {
+    Scheduler::saveState(snapshot);
+    snapshot.put(next);
+    for (int c = 0; c < cores.size(); c++) {
+        cores[c]->save(snapshot, next[c]);
+    }
+}
+
+void Partitioned::loadState(Snapshot &snapshot) {
+    Scheduler::loadState(snapshot);
+    snapshot.get(next);
+    if (next.size() != cores.size()) {
+        snapshot.fail();
+        return;
+    }
+    for (int c = 0; c < cores.size(); c++) {
+        if (cores[c]->resume(snapshot, quantum, maxTime) < 0) {
+            snapshot.fail();
+            return;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Scheduler.h"
+
+#ifndef SIMULATOR_PARTITION_H
+#define SIMULATOR_PARTITION_H
+
+// How tasks are packed onto cores. A task fits a core while the core's low
+// mode utilization, every task at lowC, and high mode utilization, high tasks
+// at highC, both stay at most 1.
+enum Packing {
+    // In set order, onto the first core it fits.
+    FirstFit,
+    // In set order, onto the core with the least low mode utilization.
+    WorstFit,
+    // High tasks by decreasing highC / T, then low tasks by decreasing
+    // lowC / T, each onto the first core it fits.
+    CriticalityDecreasing
+};
+
+// Reads "first", "worst" or "criticality".
+bool parsePacking(const std::string &value, Packing &packing);
+
+// The core of every task. A task that fits no core goes to the one with the
+// least low mode utilization, which is then overloaded like a single core set
+// can be.
+std::vector<int> pack(const std::vector<Task> &tasks, int coreNum, Packing packing);
+
+// Partitioned multiprocessor scheduling: every reset packs the task set onto
+// cores, and each core runs its own instance of a single core scheduler on
+// its partition. The counters are the sums over the cores, so the PFJs are
+// over every job of the set. schedule runs the cores on their own threads,
+// begin and step run them in lockstep. Statistics and traces are not kept.
+class Partitioned : public Scheduler {
+public:
+    // make returns a new instance of the per core scheduler, schedule runs up
+    // to threadNum cores at once.
+    Partitioned(const std::function<Scheduler*()> &make, int coreNum, Packing packing, int threadNum);
+    void schedule(int quantum, int maxTime) override;
+    int begin(int quantum, int maxTime) override;
+    int step(int time) override;
+    void finish() override;
+    void reset(const std::vector<Task>& tasksIn) override;
+
+protected:
+    void saveState(Snapshot &snapshot) const override;
+    void loadState(Snapshot &snapshot) override;
+
+private:
+    std::vector<std::unique_ptr<Scheduler>> cores;
+    std::vector<std::vector<Task>> partitions;
+    Packing packing;
+    int threadNum;
+    int quantum = 1;
+    int maxTime = 0;
+    // The next decision of every core.
+    std::vector<int> next;
+};
+
+#endif //SIMULATOR_PARTITION_H
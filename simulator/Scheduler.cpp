@@ -1,5 +1,10 @@
 #include "Scheduler.h"
 
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <unordered_map>
+
 using namespace std;
 
 Scheduler::Scheduler(const vector<Task> &tasksIn) {
@@ -10,6 +15,14 @@ int Scheduler::getContextSwitches() const {
     return switches;
 }
 
+int Scheduler::getJobs() const {
+    return succeedLow + failedLow + succeedHigh + failedHigh;
+}
+
+const SchedulerStats &Scheduler::getStats() const {
+    return stats;
+}
+
 float Scheduler::getLowPFJ() const {
     if (succeedLow + failedLow == 0) {
         return 1;
@@ -24,12 +37,206 @@ float Scheduler::getHighPFJ() const {
     return (float) succeedHigh / (float) (succeedHigh + failedHigh);
 }
 
+// A snapshot starts with the scheduler's name and number of tasks, to tell
+// whether it fits, and the time of the next decision.
+void Scheduler::save(Snapshot &snapshot, int time) const {
+    snapshot.put(name);
+    snapshot.put(tasks.size());
+    snapshot.put(time);
+    saveState(snapshot);
+}
+
+int Scheduler::resume(Snapshot &snapshot, int quantum, int maxTime) {
+    string savedName;
+    size_t taskNum;
+    int time;
+    snapshot.get(savedName);
+    snapshot.get(taskNum);
+    snapshot.get(time);
+    if (!snapshot.good() || savedName != name || taskNum != tasks.size()) {
+        return -1;
+    }
+    begin(quantum, maxTime);
+    loadState(snapshot);
+    return snapshot.good() ? time : -1;
+}
+
+void Scheduler::scheduleSteady(int quantum, int maxTime) {
+    long long hyperperiod = 1;
+    for (int i = 0; i < tasks.size() && hyperperiod <= maxTime / 2; i++) {
+        long long a = hyperperiod, b = tasks[i].period;
+        while (b != 0) {
+            long long r = a % b;
+            a = b;
+            b = r;
+        }
+        hyperperiod = hyperperiod / a * tasks[i].period;
+    }
+    bool constant = hyperperiod <= maxTime / 2;
+    for (int i = 0; i < tasks.size() && constant; i++) {
+        constant = tasks[i].arrival == Periodic && tasks[i].exeTimes.constant();
+    }
+    Snapshot probe;
+    int time = begin(quantum, maxTime);
+    if (!constant || !steadyState(probe, time)) {
+        for (; time <= maxTime; time = step(time)) {}
+        finish();
+        return;
+    }
+
+    // One sample per hyperperiod, so a cycle costs no more than the
+    // hyperperiods it takes to show.
+    struct Sample {
+        int time;
+        int counters[5];
+    };
+    vector<Sample> samples;
+    vector<Snapshot> states;
+    unordered_multimap<uint64_t, int> seen;
+    long long sampleAt = 0;
+    for (; time <= maxTime; time = step(time)) {
+        if (time >= sampleAt) {
+            Snapshot state;
+            steadyState(state, time);
+            uint64_t hash = state.hash();
+            int match = -1;
+            for (auto range = seen.equal_range(hash); range.first != range.second; ++range.first) {
+                if (states[range.first->second] == state) {
+                    match = range.first->second;
+                }
+            }
+            if (match < 0) {
+                seen.emplace(hash, (int) samples.size());
+                samples.push_back(Sample{time, {failedLow, succeedLow, failedHigh, succeedHigh, switches}});
+                states.push_back(move(state));
+                sampleAt = (time / hyperperiod + 1) * hyperperiod;
+            } else {
+                // The run from here is the one from the match, shifted: the
+                // cycles left repeat its counts, and the rest is run.
+                const Sample &from = samples[match];
+                int cycle = time - from.time;
+                int cycles = (maxTime - time) / cycle;
+                int counters[5] = {failedLow, succeedLow, failedHigh, succeedHigh, switches};
+                Snapshot snapshot;
+                save(snapshot, time);
+                TraceWriter *tracing = trace;
+                trace = nullptr;
+                int end = maxTime - cycles * cycle;
+                time = resume(snapshot, quantum, end);
+                failedLow += cycles * (counters[0] - from.counters[0]);
+                succeedLow += cycles * (counters[1] - from.counters[1]);
+                failedHigh += cycles * (counters[2] - from.counters[2]);
+                succeedHigh += cycles * (counters[3] - from.counters[3]);
+                switches += cycles * (counters[4] - from.counters[4]);
+                while (time <= end) {
+                    time = step(time);
+                }
+                finish();
+                trace = tracing;
+                return;
+            }
+        }
+    }
+    finish();
+}
+
+// Half-width of the 95% Wilson score interval of succeeded in succeeded +
+// failed trials, which unlike the normal one does not collapse at 0 or 1.
+static float wilsonHalfWidth(int succeeded, int failed) {
+    const double z = 1.96;
+    double n = (double) succeeded + failed;
+    if (n == 0) {
+        return 1;
+    }
+    double p = succeeded / n;
+    return (float) (z * sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / (1 + z * z / n));
+}
+
+Convergence Scheduler::scheduleConverged(int quantum, int maxTime, float precision, int jobBudget) {
+    // The intervals are only checked every few jobs, each check costs roots.
+    const int CHECK_JOBS = 64;
+    bool hasLow = false, hasHigh = false;
+    for (const Task &t : tasks) {
+        hasLow |= t.crit == Low;
+        hasHigh |= t.crit == High;
+    }
+
+    int checkAt = 0;
+    int time = begin(quantum, maxTime);
+    for (; time <= maxTime; time = step(time)) {
+        int jobs = getJobs();
+        if (jobBudget > 0 && jobs >= jobBudget) {
+            break;
+        }
+        if (precision > 0 && jobs >= checkAt) {
+            checkAt = jobs + CHECK_JOBS;
+            if ((!hasLow || wilsonHalfWidth(succeedLow, failedLow) <= precision) &&
+                (!hasHigh || wilsonHalfWidth(succeedHigh, failedHigh) <= precision)) {
+                break;
+            }
+        }
+    }
+    finish();
+    return Convergence{min(time, maxTime + 1), hasLow ? wilsonHalfWidth(succeedLow, failedLow) : 0,
+                       hasHigh ? wilsonHalfWidth(succeedHigh, failedHigh) : 0};
+}
+
+void Scheduler::saveState(Snapshot &snapshot) const {
+    snapshot.put(failedLow);
+    snapshot.put(succeedLow);
+    snapshot.put(failedHigh);
+    snapshot.put(succeedHigh);
+    snapshot.put(switches);
+    readyHeap.save(snapshot);
+}
+
+void Scheduler::loadState(Snapshot &snapshot) {
+    snapshot.get(failedLow);
+    snapshot.get(succeedLow);
+    snapshot.get(failedHigh);
+    snapshot.get(succeedHigh);
+    snapshot.get(switches);
+    readyHeap.load(snapshot);
+}
+
+bool Scheduler::steadyState(Snapshot &, int) const {
+    return false;
+}
+
+void Scheduler::sumCounters(const vector<unique_ptr<Scheduler>> &parts) {
+    switches = failedHigh = failedLow = succeedHigh = succeedLow = 0;
+    for (const unique_ptr<Scheduler> &part : parts) {
+        failedLow += part->failedLow;
+        succeedLow += part->succeedLow;
+        failedHigh += part->failedHigh;
+        succeedHigh += part->succeedHigh;
+        switches += part->switches;
+    }
+}
+
+void Scheduler::setTrace(TraceWriter *traceIn) {
+    trace = traceIn;
+}
+
+int Scheduler::getMigrations() const {
+    return 0;
+}
+
+vector<float> Scheduler::getCoreUtilizations() const {
+    return {};
+}
+
 std::string Scheduler::getName() const {
     return name;
 }
 
 void Scheduler::reset() {
     switches = failedHigh = failedLow = succeedHigh = succeedLow = 0;
+    STATS(stats = SchedulerStats());
+}
+
+void Scheduler::finish() {
+    STATS(stats.stop());
 }
 
 void Scheduler::reset(const vector<Task> &tasksIn) {
@@ -46,81 +253,153 @@ EDF::EDF(const std::vector<Task> &tasksIn) : Scheduler(tasksIn) {
 }
 
 void EDF::schedule(int quantum, int maxTime) {
-    int runningId = -1;
+    for (int time = begin(quantum, maxTime); time <= maxTime; time = EDF::step(time)) {}
+    finish();
+}
 
-    std::vector<TaskState> taskStates;
+int EDF::begin(int quantumIn, int maxTimeIn) {
+    quantum = quantumIn;
+    maxTime = maxTimeIn;
+    runningId = -1;
 
     reset();
 
-    for (const Task &t: tasks) {
-        taskStates.emplace_back(TaskState{Ready, 0, t.period, 0, 0});
+    taskStates.clear();
+    readyHeap.reset(tasks.size());
+    releases.reset(0);
+    TRACE(traceTime(0));
+    // A sporadic task whose first job arrives later waits for it like one
+    // that completed.
+    for (int i = 0; i < tasks.size(); i++) {
+        int arrival = tasks[i].firstArrival();
+        taskStates.emplace_back(TaskState{arrival, arrival + tasks[i].period, 0, 0});
+        if (arrival > 0) {
+            releases.add(arrival, i);
+            continue;
+        }
+        readyHeap.push(i, tasks[i].period);
+        TRACE(traceEvent(TraceRelease, i));
     }
+    return 0;
+}
 
-    for (int time = 0; time <= maxTime; time++) {
-
-        if (time % quantum == 0 ||
-            runningId >= 0 &&
-            (taskStates[runningId].exeTime >= tasks[runningId].exeTimes[taskStates[runningId].exeNum] ||
-             time > taskStates[runningId].absoluteDeadline)) {
-
-            switches += 2;
+// Event driven: only the instants at which the per-tick loop would change
+// state are visited. Quantum boundaries in between only add their switches.
+int EDF::step(int time) {
+    switches += 2;
+    STATS(stats.phase(Complete));
+    TRACE(traceTime(time));
 
-            if (runningId >= 0 &&
-                taskStates[runningId].exeTime >= tasks[runningId].exeTimes[taskStates[runningId].exeNum]) {
-                if (tasks[runningId].crit == Low) {
-                    succeedLow++;
-                } else if (tasks[runningId].crit == High) {
-                    succeedHigh++;
-                }
-                taskStates[runningId].exeNum++;
-                taskStates[runningId].state = Idle;
-                taskStates[runningId].wakeupTime += tasks[runningId].period;
-                taskStates[runningId].exeTime = 0;
-                runningId = -1;
-            }
+    if (runningId >= 0 &&
+        taskStates[runningId].exeTime >= tasks[runningId].exeTimes[taskStates[runningId].exeNum]) {
+        if (tasks[runningId].crit == Low) {
+            succeedLow++;
+        } else if (tasks[runningId].crit == High) {
+            succeedHigh++;
+        }
+        TRACE(traceEvent(TraceComplete, runningId));
+        taskStates[runningId].exeNum++;
+        taskStates[runningId].wakeupTime += tasks[runningId].interArrival(taskStates[runningId].exeNum);
+        taskStates[runningId].exeTime = 0;
+        releases.add(taskStates[runningId].wakeupTime, runningId);
+        runningId = -1;
+    }
 
-            for (int i = 0; i < tasks.size(); i++) {
-                if ((taskStates[i].state == Ready || taskStates[i].state == Running) &&
-                    time > taskStates[i].absoluteDeadline) {
-                    taskStates[i].exeNum++;
-                    taskStates[i].state = Idle;
-                    taskStates[i].wakeupTime += tasks[i].period;
-                    taskStates[i].exeTime = 0;
-                    if (tasks[i].crit == Low) {
-                        failedLow++;
-                    } else {
-                        failedHigh++;
-                    }
-                    if (i == runningId) {
-                        runningId = -1;
-                    }
-                }
-            }
+    STATS(stats.phase(Miss));
+    if (runningId >= 0 && time > taskStates[runningId].absoluteDeadline) {
+        missTask(runningId);
+        runningId = -1;
+    }
+    while (!readyHeap.empty() && time > readyHeap.topDeadline()) {
+        missTask(readyHeap.pop());
+    }
 
-            for (int i = 0; i < tasks.size(); i++) {
-                if (taskStates[i].state == Idle && time >= taskStates[i].wakeupTime) {
-                    taskStates[i].state = Ready;
-                    taskStates[i].absoluteDeadline = taskStates[i].wakeupTime + tasks[i].period;
-                }
-            }
+    STATS(stats.phase(Release));
+    releases.advance(time, [&](int i) {
+        taskStates[i].absoluteDeadline = taskStates[i].wakeupTime + tasks[i].period;
+        readyHeap.push(i, taskStates[i].absoluteDeadline);
+        TRACE(traceEvent(TraceRelease, i));
+    });
 
-            int minId = runningId;
-            for (int i = 0; i < tasks.size(); i++) {
-                if (taskStates[i].state == Ready &&
-                    (minId < 0 || taskStates[i].absoluteDeadline < taskStates[minId].absoluteDeadline)) {
-                    minId = i;
-                }
-            }
-            if (minId != runningId) {
-                if (runningId >= 0) {
-                    taskStates[runningId].state = Ready;
-                }
-                taskStates[minId].state = Running;
-                runningId = minId;
-            }
-        }
+    STATS(stats.phase(Dispatch));
+    STATS(stats.sampleQueue(readyHeap.size()));
+    if (!readyHeap.empty() &&
+        (runningId < 0 || readyHeap.topDeadline() < taskStates[runningId].absoluteDeadline)) {
         if (runningId >= 0) {
-            taskStates[runningId].exeTime++;
+            readyHeap.push(runningId, taskStates[runningId].absoluteDeadline);
+            TRACE(traceEvent(TracePreempt, runningId));
         }
+        runningId = readyHeap.pop();
+        TRACE(traceEvent(TraceDispatch, runningId));
+    }
+
+    STATS(stats.phase(Advance));
+    int next = nextEvent(time);
+    switches += 2 * ((next - 1) / quantum - time / quantum);
+    if (runningId >= 0) {
+        taskStates[runningId].exeTime += next - time;
+    }
+    return next;
+}
+
+void EDF::saveState(Snapshot &snapshot) const {
+    Scheduler::saveState(snapshot);
+    snapshot.put(taskStates);
+    snapshot.put(runningId);
+    releases.save(snapshot);
+}
+
+void EDF::loadState(Snapshot &snapshot) {
+    Scheduler::loadState(snapshot);
+    snapshot.get(taskStates);
+    snapshot.get(runningId);
+    releases.load(snapshot);
+}
+
+// The waiting tasks are those neither running nor in the heap, so the wheel
+// adds nothing. Quantum boundaries count switches, so the phase in the quantum
+// is part of the state.
+bool EDF::steadyState(Snapshot &snapshot, int time) const {
+    snapshot.put(time % quantum);
+    snapshot.put(runningId);
+    for (int i = 0; i < tasks.size(); i++) {
+        snapshot.put(taskStates[i].wakeupTime - time);
+        snapshot.put(taskStates[i].absoluteDeadline - time);
+        snapshot.put(taskStates[i].exeTime);
+        snapshot.put(readyHeap.contains(i) ? readyHeap.deadline(i) - time : INT_MIN);
+    }
+    return true;
+}
+
+int EDF::nextEvent(int time) const {
+    // Releases and misses of waiting tasks are only noticed on a quantum boundary,
+    // the running task completes or misses its deadline on the exact tick.
+    auto boundary = [&](int t) { return (t + quantum - 1) / quantum * quantum; };
+
+    int next = maxTime + 1;
+    if (runningId >= 0) {
+        int remaining = tasks[runningId].exeTimes[taskStates[runningId].exeNum] - taskStates[runningId].exeTime;
+        next = min(next, time + max(1, remaining));
+        next = min(next, max(time + 1, taskStates[runningId].absoluteDeadline + 1));
+    }
+    if (!readyHeap.empty()) {
+        next = min(next, boundary(max(time + 1, readyHeap.topDeadline() + 1)));
+    }
+    if (!releases.empty()) {
+        next = min(next, boundary(max(time + 1, releases.earliest())));
+    }
+    return next;
+}
+
+void EDF::missTask(int id) {
+    TRACE(traceEvent(TraceMiss, id));
+    taskStates[id].exeNum++;
+    taskStates[id].wakeupTime += tasks[id].interArrival(taskStates[id].exeNum);
+    taskStates[id].exeTime = 0;
+    releases.add(taskStates[id].wakeupTime, id);
+    if (tasks[id].crit == Low) {
+        failedLow++;
+    } else {
+        failedHigh++;
     }
 }
@@ -2,28 +2,81 @@
 #include <queue>
 #include <string>
 #include <list>
+#include <memory>
+#include <set>
+
+#include "DeadlineHeap.h"
+#include "DemandTree.h"
+#include "SchedulerStats.h"
+#include "Snapshot.h"
+#include "Task.h"
+#include "TaskMask.h"
+#include "TaskTable.h"
+#include "TimerWheel.h"
+#include "Trace.h"
+#include "Utilization.h"
 
 #ifndef SIMULATOR_SCHEDULER_H
 #define SIMULATOR_SCHEDULER_H
 
-enum Criticality { Low, High };
-
-struct Task {
-    int period;
-    Criticality crit;
-    int lowC;
-    int highC;
-    std::vector<int> exeTimes;
+// Where Scheduler::scheduleConverged stopped: the ticks it simulated and the
+// half-widths of the 95% Wilson score intervals of the Low and High PFJ then,
+// 0 for a criticality without tasks.
+struct Convergence {
+    int ticks;
+    float lowHalfWidth;
+    float highHalfWidth;
 };
 
 class Scheduler {
 public:
     Scheduler() = default;
     explicit Scheduler(const std::vector<Task>& tasksIn);
+    virtual ~Scheduler() = default;
     virtual void schedule(int quantum, int maxTime) = 0;
+    // The same run one decision at a time, for stepping or checkpointing a run
+    // from outside. begin returns the time of the first decision, step
+    // takes the decision at time and returns the time of the next one, and
+    // finish ends the run once that is past maxTime.
+    virtual int begin(int quantum, int maxTime) = 0;
+    virtual int step(int time) = 0;
+    virtual void finish();
+    // Checkpoints. save takes the state between two decisions, where step
+    // returned time. resume restores it on an instance of the same scheduler
+    // reset to as many tasks, and returns that time, or -1 if the snapshot is
+    // not one of it. The run goes on with step from there, with quantum and
+    // maxTime as if given to begin, and statistics start over. Resuming one
+    // snapshot on several instances forks the run: each goes on alone, for
+    // instance with other execution times or another quantum.
+    void save(Snapshot &snapshot, int time) const;
+    int resume(Snapshot &snapshot, int quantum, int maxTime);
+    // schedule, but once the steady state sampled at the first decision of
+    // every hyperperiod repeats, the counters of the whole cycles left are
+    // added instead of run, and the rest of the run is resumed from there with
+    // maxTime brought forward by those cycles. Exact, as equal states are
+    // followed by equal decisions, provided every job of a task takes the same
+    // time and every task is periodic. Otherwise, for a scheduler without a
+    // steady state or for a hyperperiod over half the run, it is schedule. Statistics start over and
+    // tracing stops when cycles are skipped.
+    void scheduleSteady(int quantum, int maxTime);
+    // schedule, but stops once both PFJ intervals are at most precision on
+    // each side, or once jobBudget jobs have ended; 0 leaves either out. The
+    // intervals take jobs as independent trials, which jobs of one task are
+    // not, so they are narrower than the PFJs' real spread over task sets.
+    Convergence scheduleConverged(int quantum, int maxTime, float precision, int jobBudget);
     float getLowPFJ() const;
     float getHighPFJ() const;
     int getContextSwitches() const;
+    int getJobs() const;
+    const SchedulerStats &getStats() const;
+    // Records the following runs to trace, or stops recording when null.
+    // Only has an effect when built with SIMULATOR_TRACE.
+    void setTrace(TraceWriter *traceIn);
+    // For schedulers of several cores that jobs move between: the jobs that
+    // went on on another core than the one they were preempted on, and the
+    // share of the run each core was busy. 0 and empty for the others.
+    virtual int getMigrations() const;
+    virtual std::vector<float> getCoreUtilizations() const;
     std::string getName() const;
     virtual void reset();
     virtual void reset(const std::vector<Task>& tasksIn);
@@ -35,7 +88,39 @@ protected:
     int failedHigh = 0;
     int succeedHigh = 0;
     int switches = 0;
+    SchedulerStats stats;
+    TraceWriter *trace = nullptr;
     std::vector<Task> tasks;
+    // Tasks that are ready and may be dispatched, keyed by the deadline the
+    // scheduler dispatches on. The running task is never in it.
+    DeadlineHeap readyHeap;
+
+    // Every scheduler saves and restores its own state after that of the
+    // scheduler it derives from.
+    virtual void saveState(Snapshot &snapshot) const;
+    virtual void loadState(Snapshot &snapshot);
+    // What the decisions after time depend on, with times relative to it and
+    // without counters or job numbers: when two states put the same bytes and
+    // execution times are constant, the runs from them only differ by the
+    // shift in time. Returns false for a scheduler that has none.
+    virtual bool steadyState(Snapshot &snapshot, int time) const;
+    // Sets the counters to the sums of those of parts, for a scheduler made of
+    // others.
+    void sumCounters(const std::vector<std::unique_ptr<Scheduler>> &parts);
+
+    // For TRACE(...) statements: the time of the decision being taken, and
+    // an event of it.
+    void traceTime(int time) {
+        if (trace != nullptr) {
+            trace->setTime(time);
+        }
+    }
+
+    void traceEvent(TraceEvent event, int id) {
+        if (trace != nullptr) {
+            trace->record(event, id);
+        }
+    }
 };
 
 class EDF : public Scheduler {
@@ -43,139 +128,229 @@ public:
     EDF();
     explicit EDF(const std::vector<Task>& tasksIn);
     void schedule(int quantum, int maxTime) override;
+    int begin(int quantum, int maxTime) override;
+    int step(int time) override;
 
-private:
-    enum State { Idle, Ready, Running };
+protected:
+    void saveState(Snapshot &snapshot) const override;
+    void loadState(Snapshot &snapshot) override;
+    bool steadyState(Snapshot &snapshot, int time) const override;
 
+private:
     struct TaskState {
-        State state;
         int wakeupTime;
         int absoluteDeadline;
         int exeTime;
         int exeNum;
     };
-};
-
-class EDFVD : public Scheduler {
-public:
-    EDFVD();
-    explicit EDFVD(const std::vector<Task>& tasksIn);
-    void schedule(int quantum, int maxTime) override;
 
-private:
-    enum State { Idle, Ready, Running};
-    enum CritState { HighMode, LowMode};
+    int nextEvent(int time) const;
+    void missTask(int id);
 
-    struct TaskState {
-        State state;
-        int wakeupTime;
-        int absoluteDeadline;
-        int schedulingDeadline;
-        int exeTime;
-        int exeNum;
-    };
     std::vector<TaskState> taskStates;
-    void completeTask(int id, bool success);
+    int runningId = -1;
+    int quantum = 1;
+    int maxTime = 0;
+
+    // Wakeups of the tasks waiting for their next release, by id; the other
+    // tasks are ready or running.
+    TimerWheel releases;
 };
 
-class FMC : public Scheduler {
+class RED : public Scheduler {
 public:
-    FMC();
-    explicit FMC(const std::vector<Task>& tasksIn);
+    RED();
+    RED(const std::vector<Task>& tasksIn);
     void schedule(int quantum, int maxTime) override;
+    int begin(int quantum, int maxTime) override;
+    int step(int time) override;
+
+    void reset();
+    void reset(const std::vector<Task> &tasksIn);
+
+protected:
+    void saveState(Snapshot &snapshot) const override;
+    void loadState(Snapshot &snapshot) override;
 
 private:
-    enum State { Idle, Ready, Running};
     enum CritState { HighMode, LowMode};
 
-    struct TaskState {
-        State state;
-        CritState level;
-        int wakeupTime;
-        int absoluteDeadline;
-        int schedulingDeadline;
-        int lowBudget;
-        int exeTime;
-        int exeNum;
-    };
+    bool addToQueue(int id);
+    bool removeVictim();
+    void removeRunning();
+    void removeId(int id);
+    void reject(int id);
+    void unreject(int id);
+
+    TaskTable table;
+    std::vector<int> exeNum;
+    // A task is ready when it is neither idle nor rejected.
+    TaskMask idle;
+    TaskMask rejected;
+    DemandTree readyQueue;
+    // Rejected jobs by latest deadline first, the candidates for re-admission.
+    std::set<std::pair<int, int>> rejectedHigh;
+    std::set<std::pair<int, int>> rejectedLow;
 };
 
-class FMC_Drop : public Scheduler {
+// Cycle-accurate model of the hardware scheduler in
+// scheduler/verilog/SKELETON.sv, one tick per clock, driven like a testbench
+// whose CPU runs running_task: task i is loaded on clock i, and completion is
+// signalled once the running job has run its execution time. Completions are
+// always successful, so BLOCKED never occurs. Sporadic tasks are loaded as
+// SPORADIC, and the testbench raises wakeup_valid for their jobs as they
+// arrive, one a clock and each only once the task's previous job has ended;
+// the RTL counts their deadlines from the clock they are inserted on. Field
+// widths, the shift-register ready_queue, the utilization dropping and the
+// TIME_BITS wraparound follow the RTL, quirks included. Only the first
+// MAX_TASKS tasks are loaded.
+//
+// A job succeeds if the CPU signalled completion, and fails if it was popped
+// for its deadline or budget, skipped while task wakeup_id was dropped, or
+// raised while its own task was dropped, which only re-enables the task.
+// wakeup_id is 0 on clocks without a wakeup. Switches count cpu_interrupt.
+class Skeleton : public Scheduler {
 public:
-    FMC_Drop();
-    explicit FMC_Drop(const std::vector<Task>& tasksIn);
+    static const int MAX_TASKS = 32;
+    static const int MAX_UTIL_PRECISION = 1024;
+
+    Skeleton();
+    explicit Skeleton(const std::vector<Task>& tasksIn);
+    // A timeBits below 32 makes current_time wrap around in short runs.
+    explicit Skeleton(int timeBits);
     void schedule(int quantum, int maxTime) override;
+    int begin(int quantum, int maxTime) override;
+    int step(int time) override;
+
+protected:
+    void saveState(Snapshot &snapshot) const override;
+    void loadState(Snapshot &snapshot) override;
 
 private:
-    enum State { Idle, Ready, Running};
-    enum CritState { HighMode, LowMode};
+    typedef FixedUtilization<10> HardwareUtilization;
+    static_assert(HardwareUtilization::ONE == MAX_UTIL_PRECISION, "utilizations out of MAX_UTIL_PRECISION");
 
-    struct TaskState {
+    // As in the RTL.
+    enum TaskType { PERIODIC, SPORADIC };
+    enum Level { LOW, HIGH_HIGH_MODE, HIGH_LOW_MODE };
+    enum State { IDLE, DROPPED, BLOCKED, READY };
+
+    struct Entry {
+        bool valid;
+        TaskType taskType;
+        Level criticality;
         State state;
-        CritState level;
-        int wakeupTime;
-        int absoluteDeadline;
-        int schedulingDeadline;
-        int exeTime;
-        int exeNum;
-        bool enabled;
+        uint32_t period;
+        uint32_t virtualDeadline;
+        uint32_t exHigh;
+        uint32_t exLow;
+        uint32_t utilization;
+        uint32_t wakeup;
+        uint32_t absoluteDeadline;
+        uint32_t schedulingDeadline;
+        uint32_t exTime;
     };
-};
 
-class H_FMC : public Scheduler {
-public:
-    H_FMC();
-    explicit H_FMC(const std::vector<Task>& tasksIn);
-    void schedule(int quantum, int maxTime) override;
+    Entry input(int id) const;
+    int need(int id) const;
+    void endJob(int id, bool success);
 
-private:
-    enum State { Idle, Ready, Running};
-    enum CritState { HighMode, LowMode};
+    uint32_t timeMask;
+    uint32_t timeMsb;
+    int loaded = 0;
+    HardwareUtilization lamda;
 
-    void completeTask(int id, bool success);
+    // Registers.
+    uint32_t currentTime = 0;
+    uint32_t maxUtilization = 0;
+    uint32_t curUtilization = 0;
+    uint32_t targetUtilization = 0;
+    Entry taskTable[MAX_TASKS];
+    int readyQueue[MAX_TASKS];
+    int queueSize = 0;
+    int currentCriticality = 0;
 
-    struct TaskState {
-        State state;
-        CritState level;
-        int wakeupTime;
-        int absoluteDeadline;
-        int schedulingDeadline;
-        int exeTime;
-        int exeNum;
-        bool enabled;
-    };
-    std::vector<TaskState> taskStates;
+    // The next state, as always_comb computes it.
+    Entry nTaskTable[MAX_TASKS];
+    int nReadyQueue[MAX_TASKS];
+
+    // The CPU side: clocks the current job of each task has run, and its
+    // number.
+    std::vector<int> executed;
+    std::vector<int> exeNum;
+    // The testbench's sporadic arrivals: the next one of every sporadic task,
+    // and per task the time of that one, the jobs arrived and those raised.
+    TimerWheel arrivals;
+    std::vector<int> arrivalTime;
+    std::vector<int> arrived;
+    std::vector<int> raised;
+    std::vector<int> due;
 };
 
-class RED : public Scheduler {
+// Global EDF-VD on coreNum identical cores: the coreNum ready jobs with the
+// earliest scheduling deadlines run, high tasks on virtual deadlines shrunk by
+// lamda while in low mode, with lamda taken from the utilizations per core.
+// The first high job to run past its lowC switches the whole system to high
+// mode, failing every low job and giving high tasks their real deadlines,
+// until no core has a job to run. Decisions are EDF's: releases and misses of
+// jobs not running are noticed on quantum boundaries, completions, overruns
+// and misses of running ones on the exact tick. Switches are counted per core
+// like EDF-VD's: two for each quantum boundary, idle cores included, and two
+// for each decision between them that the core's job brought about. A job that resumes goes
+// back to its last core if that is free.
+class GlobalEDFVD : public Scheduler {
 public:
-    RED();
-    RED(const std::vector<Task>& tasksIn);
+    explicit GlobalEDFVD(int coreNum);
     void schedule(int quantum, int maxTime) override;
+    int begin(int quantum, int maxTime) override;
+    int step(int time) override;
+    int getMigrations() const override;
+    std::vector<float> getCoreUtilizations() const override;
 
-    void reset();
-    void reset(const std::vector<Task> &tasksIn);
+protected:
+    void saveState(Snapshot &snapshot) const override;
+    void loadState(Snapshot &snapshot) override;
 
 private:
-    enum State { Idle, Ready, Reject};
-    enum CritState { HighMode, LowMode};
-
     struct TaskState {
-        State state;
         int wakeupTime;
         int absoluteDeadline;
-        int wcet;
+        int schedulingDeadline;
         int exeTime;
         int exeNum;
+        // The core the job runs on, or -1, and the one it ran on last.
+        int core;
+        int lastCore;
     };
 
-    bool addToQueue(int id);
-    bool removeVictim();
-    void removeRunning();
-    void removeId(int id);
+    void release(int id);
+    void endJob(int id, bool success);
+    void switchMode(int id);
+    void dispatch();
+    void run(int id);
+    void preempt(int id);
+    int nextEvent(int time) const;
 
+    int coreNum;
+    int quantum = 1;
+    int maxTime = 0;
+    int mode = 0;
+    Utilization lamda;
     std::vector<TaskState> taskStates;
-    std::list<int> readyQueue;
+    // The running jobs by (scheduling deadline, id), so the last one is the
+    // first to be preempted. At most coreNum, each on its own core.
+    std::set<std::pair<int, int>> running;
+    std::vector<int> freeCores;
+    // Every released job that has not ended, by absolute deadline, for misses.
+    DeadlineHeap active;
+    // Wakeups of the tasks waiting for their next release.
+    TimerWheel releases;
+    // Scratch for the tasks a step works through.
+    std::vector<int> due;
+    int migrations = 0;
+    // Ticks each core was busy, up to elapsed.
+    std::vector<long long> busy;
+    int elapsed = 0;
 };
 
 #endif //SIMULATOR_SCHEDULER_H
@@ -0,0 +1,60 @@
+#include <chrono>
+#include <vector>
+
+#ifndef SIMULATOR_SCHEDULERSTATS_H
+#define SIMULATOR_SCHEDULERSTATS_H
+
+// Statistics are only collected when built with SIMULATOR_STATS, otherwise
+// every STATS(...) statement compiles to nothing and getStats stays empty.
+#ifdef SIMULATOR_STATS
+#define STATS(statement) statement
+#else
+#define STATS(statement)
+#endif
+
+// The parts of a scheduling decision that wall-clock time is charged to.
+// Advance is everything between two decisions.
+enum Phase { Complete, Miss, Release, Dispatch, Advance, PhaseCount };
+
+const char *const PHASE_NAMES[PhaseCount] = {"complete", "miss", "release", "dispatch", "advance"};
+
+struct SchedulerStats {
+    long long modeSwitches = 0;
+    // Low tasks disabled and enabled again by EDF-VD, FMC_Drop and H-FMC.
+    long long dropped = 0;
+    long long reenabled = 0;
+    // Jobs RED rejected as victims and later admitted again.
+    long long rejected = 0;
+    long long readmitted = 0;
+    // readyQueueLength[n] is the number of decisions taken with n ready tasks.
+    std::vector<long long> readyQueueLength;
+    double phaseSeconds[PhaseCount] = {};
+
+    void sampleQueue(int length) {
+        if (length >= readyQueueLength.size()) {
+            readyQueueLength.resize(length + 1);
+        }
+        readyQueueLength[length]++;
+    }
+
+    // Charges the time since the last call to the phase that was running and
+    // starts timing next.
+    void phase(Phase next) {
+        auto now = std::chrono::steady_clock::now();
+        if (current != PhaseCount) {
+            phaseSeconds[current] += std::chrono::duration<double>(now - since).count();
+        }
+        current = next;
+        since = now;
+    }
+
+    void stop() {
+        phase(PhaseCount);
+    }
+
+private:
+    Phase current = PhaseCount;
+    std::chrono::steady_clock::time_point since;
+};
+
+#endif //SIMULATOR_SCHEDULERSTATS_H
@@ -0,0 +1,306 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+
+using namespace std;
+
+GlobalEDFVD::GlobalEDFVD(int coreNum) : coreNum(coreNum) {
+    name = "G-EDF-VD";
+}
+
+void GlobalEDFVD::schedule(int quantum, int maxTime) {
+    for (int time = begin(quantum, maxTime); time <= maxTime; time = GlobalEDFVD::step(time)) {}
+    finish();
+}
+
+int GlobalEDFVD::begin(int quantumIn, int maxTimeIn) {
+    quantum = quantumIn;
+    maxTime = maxTimeIn;
+    mode = 0;
+    migrations = 0;
+    elapsed = 0;
+
+    reset();
+
+    Utilization uLow, uHighLowMode;
+    for (const Task &t : tasks) {
+        if (t.crit == Low) {
+            uLow += Utilization::ratio(t.lowC, t.period);
+        } else {
+            uHighLowMode += Utilization::ratio(t.lowC, t.period);
+        }
+    }
+    // Both normalized by the cores: uHighLowMode / M over 1 - uLow / M.
+    lamda = uHighLowMode / (Utilization::ratio(coreNum, 1) - uLow);
+
+    taskStates.assign(tasks.size(), TaskState{0, 0, 0, 0, 0, -1, -1});
+    readyHeap.reset(tasks.size());
+    active.reset(tasks.size());
+    releases.reset(0);
+    running.clear();
+    freeCores.clear();
+    for (int c = coreNum - 1; c >= 0; c--) {
+        freeCores.push_back(c);
+    }
+    busy.assign(coreNum, 0);
+    TRACE(traceTime(0));
+    for (int i = 0; i < tasks.size(); i++) {
+        taskStates[i].wakeupTime = tasks[i].firstArrival();
+        if (taskStates[i].wakeupTime > 0) {
+            releases.add(taskStates[i].wakeupTime, i);
+        } else {
+            release(i);
+        }
+    }
+    return 0;
+}
+
+int GlobalEDFVD::step(int time) {
+    STATS(stats.phase(Complete));
+    TRACE(traceTime(time));
+
+    due.clear();
+    for (const pair<int, int> &job : running) {
+        due.push_back(job.second);
+    }
+    // Every core decides on a boundary, between them only those whose job
+    // completes, overruns or misses.
+    if (time % quantum == 0) {
+        switches += 2 * coreNum;
+    } else {
+        for (int id : due) {
+            const TaskState &s = taskStates[id];
+            if (s.exeTime >= tasks[id].exeTimes[s.exeNum] || time > s.absoluteDeadline ||
+                (mode == 0 && tasks[id].crit == High && s.exeTime > tasks[id].lowC)) {
+                switches += 2;
+            }
+        }
+    }
+    for (int id : due) {
+        if (taskStates[id].exeTime >= tasks[id].exeTimes[taskStates[id].exeNum]) {
+            endJob(id, true);
+        }
+    }
+    // Jobs that overran within the same decision cannot be told apart, so the
+    // switch goes to the one with the earliest scheduling deadline rather than
+    // the first to overrun. Only the mode switch event's id depends on it, the
+    // PFJs and switches do not.
+    if (mode == 0) {
+        for (const pair<int, int> &job : running) {
+            int id = job.second;
+            if (tasks[id].crit == High && taskStates[id].exeTime > tasks[id].lowC) {
+                switchMode(id);
+                break;
+            }
+        }
+    }
+
+    STATS(stats.phase(Miss));
+    while (!active.empty() && time > active.topDeadline()) {
+        endJob(active.top(), false);
+    }
+
+    // Releases can end jobs and so add timers, which firing must not.
+    STATS(stats.phase(Release));
+    due.clear();
+    releases.advance(time, [&](int i) {
+        due.push_back(i);
+    });
+    for (int id : due) {
+        release(id);
+    }
+
+    STATS(stats.phase(Dispatch));
+    STATS(stats.sampleQueue(readyHeap.size()));
+    dispatch();
+    if (running.empty() && mode > 0) {
+        TRACE(traceEvent(TraceModeSwitch, -1));
+        mode = 0;
+    }
+
+    STATS(stats.phase(Advance));
+    int next = nextEvent(time);
+    switches += 2 * coreNum * ((next - 1) / quantum - time / quantum);
+    for (const pair<int, int> &job : running) {
+        taskStates[job.second].exeTime += next - time;
+        busy[taskStates[job.second].core] += next - time;
+    }
+    elapsed = next;
+    return next;
+}
+
+// In high mode a low job fails as soon as it is released.
+void GlobalEDFVD::release(int id) {
+    TaskState &s = taskStates[id];
+    TRACE(traceEvent(TraceRelease, id));
+    s.absoluteDeadline = s.wakeupTime + tasks[id].period;
+    if (mode > 0 && tasks[id].crit == Low) {
+        TRACE(traceEvent(TraceDrop, id));
+        endJob(id, false);
+        return;
+    }
+    if (mode == 0 && tasks[id].crit == High) {
+        int64_t deadline = (int64_t) s.wakeupTime + lamda.scale(tasks[id].period);
+        s.schedulingDeadline = (int) min(deadline, (int64_t) INT_MAX);
+    } else {
+        s.schedulingDeadline = s.absoluteDeadline;
+    }
+    readyHeap.push(id, s.schedulingDeadline);
+    active.push(id, s.absoluteDeadline);
+}
+
+void GlobalEDFVD::endJob(int id, bool success) {
+    TaskState &s = taskStates[id];
+    if (success) {
+        if (tasks[id].crit == Low) {
+            succeedLow++;
+        } else {
+            succeedHigh++;
+        }
+    } else {
+        if (tasks[id].crit == Low) {
+            failedLow++;
+        } else {
+            failedHigh++;
+        }
+    }
+    TRACE(traceEvent(success ? TraceComplete : TraceMiss, id));
+    if (s.core >= 0) {
+        running.erase(make_pair(s.schedulingDeadline, id));
+        freeCores.push_back(s.core);
+        s.core = -1;
+    }
+    readyHeap.erase(id);
+    active.erase(id);
+    s.exeNum++;
+    s.wakeupTime += tasks[id].interArrival(s.exeNum);
+    s.exeTime = 0;
+    s.lastCore = -1;
+    releases.add(s.wakeupTime, id);
+}
+
+void GlobalEDFVD::switchMode(int id) {
+    STATS(stats.modeSwitches++);
+    TRACE(traceEvent(TraceModeSwitch, id));
+    mode = 1;
+    for (int i = 0; i < tasks.size(); i++) {
+        if (!active.contains(i)) {
+            continue;
+        }
+        TaskState &s = taskStates[i];
+        if (tasks[i].crit == Low) {
+            STATS(stats.dropped++);
+            TRACE(traceEvent(TraceDrop, i));
+            endJob(i, false);
+        } else if (s.core >= 0) {
+            running.erase(make_pair(s.schedulingDeadline, i));
+            s.schedulingDeadline = s.absoluteDeadline;
+            running.insert(make_pair(s.schedulingDeadline, i));
+        } else {
+            s.schedulingDeadline = s.absoluteDeadline;
+            readyHeap.setDeadline(i, s.schedulingDeadline);
+        }
+    }
+    readyHeap.rebuild();
+}
+
+// Fills the free cores, then preempts the latest running deadline while the
+// heap has an earlier one. Like EDF, an equal deadline does not preempt.
+void GlobalEDFVD::dispatch() {
+    while (!readyHeap.empty()) {
+        if (freeCores.empty()) {
+            if (readyHeap.topDeadline() >= running.rbegin()->first) {
+                return;
+            }
+            preempt(running.rbegin()->second);
+        }
+        run(readyHeap.pop());
+    }
+}
+
+void GlobalEDFVD::run(int id) {
+    TaskState &s = taskStates[id];
+    auto core = find(freeCores.begin(), freeCores.end(), s.lastCore);
+    if (core == freeCores.end()) {
+        core = freeCores.end() - 1;
+    }
+    s.core = *core;
+    freeCores.erase(core);
+    if (s.lastCore >= 0 && s.lastCore != s.core) {
+        migrations++;
+    }
+    s.lastCore = s.core;
+    running.insert(make_pair(s.schedulingDeadline, id));
+    TRACE(traceEvent(TraceDispatch, id));
+}
+
+void GlobalEDFVD::preempt(int id) {
+    TaskState &s = taskStates[id];
+    TRACE(traceEvent(TracePreempt, id));
+    running.erase(make_pair(s.schedulingDeadline, id));
+    freeCores.push_back(s.core);
+    s.core = -1;
+    readyHeap.push(id, s.schedulingDeadline);
+}
+
+int GlobalEDFVD::nextEvent(int time) const {
+    auto boundary = [&](int t) { return (t + quantum - 1) / quantum * quantum; };
+
+    int next = maxTime + 1;
+    for (const pair<int, int> &job : running) {
+        int id = job.second;
+        const TaskState &s = taskStates[id];
+        next = min(next, time + max(1, tasks[id].exeTimes[s.exeNum] - s.exeTime));
+        if (mode == 0 && tasks[id].crit == High) {
+            next = min(next, time + max(1, tasks[id].lowC - s.exeTime + 1));
+        }
+        next = min(next, max(time + 1, s.absoluteDeadline + 1));
+    }
+    if (!active.empty()) {
+        next = min(next, boundary(max(time + 1, active.topDeadline() + 1)));
+    }
+    if (!releases.empty()) {
+        next = min(next, boundary(max(time + 1, releases.earliest())));
+    }
+    return next;
+}
+
+int GlobalEDFVD::getMigrations() const {
+    return migrations;
+}
+
+vector<float> GlobalEDFVD::getCoreUtilizations() const {
+    vector<float> utilizations;
+    for (long long ticks : busy) {
+        utilizations.push_back(elapsed > 0 ? (float) ((double) ticks / elapsed) : 0);
+    }
+    return utilizations;
+}
+
+void GlobalEDFVD::saveState(Snapshot &snapshot) const {
+    Scheduler::saveState(snapshot);
+    snapshot.put(mode);
+    snapshot.put(lamda);
+    snapshot.put(taskStates);
+    snapshot.put(running);
+    snapshot.put(freeCores);
+    active.save(snapshot);
+    releases.save(snapshot);
+    snapshot.put(migrations);
+    snapshot.put(busy);
+    snapshot.put(elapsed);
+}
+
+void GlobalEDFVD::loadState(Snapshot &snapshot) {
+    Scheduler::loadState(snapshot);
+    snapshot.get(mode);
+    snapshot.get(lamda);
+    snapshot.get(taskStates);
+    snapshot.get(running);
+    snapshot.get(freeCores);
+    active.load(snapshot);
+    releases.load(snapshot);
+    snapshot.get(migrations);
+    snapshot.get(busy);
+    snapshot.get(elapsed);
+}
@@ -8,199 +8,203 @@ RED::RED() {
 
 RED::RED(const vector<Task> &tasksIn) : Scheduler(tasksIn) {
     name = "RED";
-    for (const Task &t: tasks) {
-        taskStates.emplace_back(TaskState{Idle, 0, t.period, 0, 0, 0});
-    }
 }
 
 void RED::reset() {
-    for (TaskState &t: taskStates) {
-        t.state = Idle;
-        t.wakeupTime = 0;
-        t.absoluteDeadline = 0;
-        t.wcet = 0;
-        t.exeTime = 0;
-        t.exeNum = 0;
+    table.reset(tasks.size());
+    for (int i = 0; i < tasks.size(); i++) {
+        table.wakeupTime[i] = tasks[i].firstArrival();
+        table.absoluteDeadline[i] = 0;
+        table.sleep(i);
     }
-    readyQueue.clear();
+    exeNum.assign(tasks.size(), 0);
+    idle.reset(tasks.size());
+    idle.fill();
+    rejected.reset(tasks.size());
+    readyQueue.reset(tasks.size());
+    rejectedHigh.clear();
+    rejectedLow.clear();
     switches = failedHigh = failedLow = succeedHigh = succeedLow = 0;
+    STATS(stats = SchedulerStats());
 }
 
 
 void RED::reset(const vector<Task> &tasksIn) {
     tasks = tasksIn;
-    taskStates.clear();
-    for (const Task &t: tasks) {
-        taskStates.emplace_back(TaskState{Idle, 0, t.period, 0, 0, 0});
-    }
     reset();
 }
 
 void RED::schedule(int quantum, int maxTime) {
+    for (int time = begin(quantum, maxTime); time <= maxTime; time = RED::step(time)) {}
+    finish();
+}
+
+// RED decides on every tick, whatever the quantum.
+int RED::begin(int, int) {
     reset();
-    quantum = 1;
-
-    for (int time = 0; time <= maxTime; time++) {
-        switches++;
-
-        int runningId = readyQueue.front();
-
-        if (runningId >= 0 &&
-            taskStates[runningId].exeTime >= tasks[runningId].exeTimes[taskStates[runningId].exeNum]) {
-            if (tasks[runningId].crit == Low) {
-                succeedLow++;
-            } else if (tasks[runningId].crit == High) {
-                succeedHigh++;
-            }
-            taskStates[runningId].exeNum++;
-            taskStates[runningId].state = Idle;
-            taskStates[runningId].wakeupTime += tasks[runningId].period;
-            taskStates[runningId].exeTime = 0;
-            removeRunning();
-        }
+    return 0;
+}
 
-        for (int i = 0; i < tasks.size(); i++) {
-            if ((taskStates[i].state == Ready || taskStates[i].state == Reject) &&
-                time > taskStates[i].absoluteDeadline) {
-                if (taskStates[i].state == Ready) {
-                    removeId(i);
-                }
-                taskStates[i].exeNum++;
-                taskStates[i].state = Idle;
-                taskStates[i].wakeupTime += tasks[i].period;
-                taskStates[i].exeTime = 0;
-                if (tasks[i].crit == Low) {
-                    failedLow++;
-                } else {
-                    failedHigh++;
-                }
-            }
-        }
+int RED::step(int time) {
+    switches++;
+    STATS(stats.phase(Complete));
+    TRACE(traceTime(time));
 
-        for (int i = 0; i < tasks.size(); i++) {
-            if (taskStates[i].state == Idle && time >= taskStates[i].wakeupTime) {
-                taskStates[i].state = Ready;
-                taskStates[i].absoluteDeadline = taskStates[i].wakeupTime + tasks[i].period;
-                addToQueue(i);
-                while (!removeVictim()) {}
-            }
-        }
+    int runningId = readyQueue.front();
 
-        if (!readyQueue.empty()) {
-            taskStates[readyQueue.front()].exeTime += quantum;
+    if (runningId >= 0 &&
+        table.exeTime[runningId] >= tasks[runningId].exeTimes[exeNum[runningId]]) {
+        if (tasks[runningId].crit == Low) {
+            succeedLow++;
+        } else if (tasks[runningId].crit == High) {
+            succeedHigh++;
         }
+        TRACE(traceEvent(TraceComplete, runningId));
+        exeNum[runningId]++;
+        idle.insert(runningId);
+        table.wakeupTime[runningId] += tasks[runningId].interArrival(exeNum[runningId]);
+        table.exeTime[runningId] = 0;
+        table.sleep(runningId);
+        removeRunning();
     }
-}
 
-bool RED::addToQueue(int id) {
-    auto it = readyQueue.rbegin();
-    bool ret = true;
-    int wcet = tasks[id].crit == High ? tasks[id].highC : tasks[id].lowC;
-    for (; it != readyQueue.rend() && taskStates[id].absoluteDeadline < taskStates[*it].absoluteDeadline; it++) {
-        taskStates[*it].wcet += wcet;
-        if (taskStates[*it].wcet > tasks[*it].period) {
-            ret = false;
+    STATS(stats.phase(Miss));
+    table.advance(time, idle);
+    const TaskMask &late = table.late();
+    for (int i = late.first(); i >= 0; i = late.next(i + 1)) {
+        if (!rejected.contains(i)) {
+            removeId(i);
+        } else {
+            unreject(i);
+        }
+        TRACE(traceEvent(TraceMiss, i));
+        exeNum[i]++;
+        idle.insert(i);
+        rejected.erase(i);
+        table.wakeupTime[i] += tasks[i].interArrival(exeNum[i]);
+        table.exeTime[i] = 0;
+        table.sleep(i);
+        if (tasks[i].crit == Low) {
+            failedLow++;
+        } else {
+            failedHigh++;
         }
     }
 
-    if (it != readyQueue.rend()) {
-        wcet += taskStates[*it].wcet;
-    }
-    taskStates[id].wcet = wcet;
-    readyQueue.insert(it.base(), id);
-    if (wcet > tasks[id].period) {
-        ret = false;
+    STATS(stats.phase(Release));
+    table.advance(time, idle);
+    const TaskMask &due = table.due();
+    for (int i = due.first(); i >= 0; i = due.next(i + 1)) {
+        idle.erase(i);
+        table.absoluteDeadline[i] = table.wakeupTime[i] + tasks[i].period;
+        table.wake(i);
+        TRACE(traceEvent(TraceRelease, i));
+        addToQueue(i);
+        while (!removeVictim()) {}
     }
-    return ret;
-}
 
-bool RED::removeVictim() {
-    int overloadId = -1;
-    auto it = readyQueue.begin();
-    auto removeIt = readyQueue.end();
-    for (; it != readyQueue.end(); it++) {
-        if (taskStates[*it].wcet > tasks[*it].period) {
-            overloadId = *it;
-            break;
+    STATS(stats.phase(Advance));
+    STATS(stats.sampleQueue(readyQueue.size()));
+    // A job that ended was reset to no execution time, one that was rejected
+    // is traced as dropped.
+    TRACE(if (readyQueue.front() != runningId) {
+        if (runningId >= 0 && table.exeTime[runningId] > 0 && !rejected.contains(runningId)) {
+            traceEvent(TracePreempt, runningId);
         }
-        if (tasks[*it].crit == Low) {
-            removeIt = it;
+        if (readyQueue.front() >= 0) {
+            traceEvent(TraceDispatch, readyQueue.front());
         }
+    });
+    if (!readyQueue.empty()) {
+        table.exeTime[readyQueue.front()]++;
     }
+    return time + 1;
+}
+
+void RED::saveState(Snapshot &snapshot) const {
+    Scheduler::saveState(snapshot);
+    table.save(snapshot);
+    snapshot.put(exeNum);
+    idle.save(snapshot);
+    rejected.save(snapshot);
+    readyQueue.save(snapshot);
+    snapshot.put(rejectedHigh);
+    snapshot.put(rejectedLow);
+}
+
+void RED::loadState(Snapshot &snapshot) {
+    Scheduler::loadState(snapshot);
+    table.load(snapshot);
+    snapshot.get(exeNum);
+    idle.load(snapshot);
+    rejected.load(snapshot);
+    readyQueue.load(snapshot);
+    snapshot.get(rejectedHigh);
+    snapshot.get(rejectedLow);
+}
+
+bool RED::addToQueue(int id) {
+    int wcet = tasks[id].crit == High ? tasks[id].highC : tasks[id].lowC;
+    readyQueue.insert(id, table.absoluteDeadline[id], wcet, tasks[id].period, tasks[id].crit == Low);
+    return readyQueue.firstOverloaded() < 0;
+}
+
+bool RED::removeVictim() {
+    int overloadId = readyQueue.firstOverloaded();
     if (overloadId == -1) {
         return true;
     }
-    if (tasks[overloadId].crit == Low || removeIt == readyQueue.end()) {
-        removeIt = it;
-    }
-
-    it = removeIt;
-    bool ret = true;
-    int wcet = tasks[*it].crit == High ? tasks[*it].highC : tasks[*it].lowC;
-
-    for (it++; it != readyQueue.end(); it++) {
-        taskStates[*it].wcet -= wcet;
-        if (taskStates[*it].wcet > tasks[*it].period && ret) {
-            ret = false;
+    int victimId = overloadId;
+    if (tasks[overloadId].crit == High) {
+        int lowId = readyQueue.lastLowBefore(overloadId);
+        if (lowId >= 0) {
+            victimId = lowId;
         }
     }
-    taskStates[*removeIt].state = Reject;
-    readyQueue.erase(removeIt);
-    return ret;
+    readyQueue.erase(victimId);
+    reject(victimId);
+    return readyQueue.firstOverloaded() < 0;
 }
 
 void RED::removeRunning() {
-    auto it = readyQueue.begin();
-    if (it == readyQueue.end()) {
+    if (readyQueue.empty()) {
         return;
     }
-
-    bool ret = true;
-    int wcet = tasks[*it].crit == High ? tasks[*it].highC : tasks[*it].lowC;
-    for (it++; it != readyQueue.end(); it++) {
-        taskStates[*it].wcet -= wcet;
-        if (taskStates[*it].wcet > tasks[*it].period && ret) {
-            ret = false;
+    readyQueue.erase(readyQueue.front());
+
+    if (readyQueue.firstOverloaded() < 0) {
+        int chosenId = -1;
+        if (!rejectedHigh.empty()) {
+            chosenId = rejectedHigh.begin()->second;
+        } else if (!rejectedLow.empty()) {
+            chosenId = rejectedLow.begin()->second;
         }
-    }
-    readyQueue.erase(readyQueue.begin());
-
-    if (ret) {
-        int chosenLowId = -1;
-        int chosenHighId = -1;
-        for (int i = 0; i < tasks.size(); i++) {
-            if (taskStates[i].state == Reject) {
-                if (tasks[i].crit == High && (chosenHighId == -1 || taskStates[i].absoluteDeadline > taskStates[chosenHighId].absoluteDeadline)) {
-                    chosenHighId = i;
-                }
-                if (tasks[i].crit == Low && (chosenLowId == -1 || taskStates[i].absoluteDeadline > taskStates[chosenLowId].absoluteDeadline)) {
-                    chosenLowId = i;
-                }
-            }
-        }
-        int chosenId = chosenHighId >= 0 ? chosenHighId : chosenLowId;
         if (chosenId == -1) {
             return;
         }
         if (!addToQueue(chosenId)) {
             removeId(chosenId);
         } else {
-            taskStates[chosenId].state = Ready;
+            unreject(chosenId);
+            rejected.erase(chosenId);
+            STATS(stats.readmitted++);
         }
     }
 }
 
 void RED::removeId(int id) {
-    auto it = readyQueue.begin();
-    auto removeIt = readyQueue.end();
-    int wcet = 0;
-    for (; it != readyQueue.end(); it++) {
-        if (*it == id) {
-            removeIt = it;
-            wcet = tasks[*it].crit == High ? tasks[*it].highC : tasks[*it].lowC;
-        } else if (removeIt != readyQueue.end()) {
-            taskStates[*it].wcet -= wcet;
-        }
-    }
-    readyQueue.erase(removeIt);
+    readyQueue.erase(id);
+}
+
+void RED::reject(int id) {
+    STATS(stats.rejected++);
+    TRACE(traceEvent(TraceDrop, id));
+    rejected.insert(id);
+    auto &queue = tasks[id].crit == High ? rejectedHigh : rejectedLow;
+    queue.emplace(-table.absoluteDeadline[id], id);
+}
+
+void RED::unreject(int id) {
+    auto &queue = tasks[id].crit == High ? rejectedHigh : rejectedLow;
+    queue.erase(make_pair(-table.absoluteDeadline[id], id));
 }
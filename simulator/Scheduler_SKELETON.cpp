@@ -0,0 +1,393 @@
+#include "Scheduler.h"
+
+using namespace std;
+
+static const uint32_t UTIL_MASK = Skeleton::MAX_UTIL_PRECISION - 1;
+static const int TASK_MASK = Skeleton::MAX_TASKS - 1;
+
+Skeleton::Skeleton() : Skeleton(32) {}
+
+Skeleton::Skeleton(const vector<Task> &tasksIn) : Skeleton(32) {
+    tasks = tasksIn;
+}
+
+Skeleton::Skeleton(int timeBits) {
+    name = "SKELETON";
+    timeMask = timeBits >= 32 ? ~(uint32_t) 0 : ((uint32_t) 1 << timeBits) - 1;
+    timeMsb = (uint32_t) 1 << (timeBits - 1);
+}
+
+void Skeleton::schedule(int quantum, int maxTime) {
+    for (int time = begin(quantum, maxTime); time <= maxTime; time = Skeleton::step(time)) {}
+    finish();
+}
+
+// The clock after reset. The hardware decides on every clock, whatever the
+// quantum.
+int Skeleton::begin(int, int) {
+    reset();
+    loaded = min((int) tasks.size(), (int) MAX_TASKS);
+
+    HardwareUtilization uLow;
+    HardwareUtilization uHighLowMode;
+    for (int i = 0; i < loaded; i++) {
+        if (tasks[i].crit == Low) {
+            uLow += HardwareUtilization::ratio(tasks[i].lowC, tasks[i].period);
+        } else {
+            uHighLowMode += HardwareUtilization::ratio(tasks[i].lowC, tasks[i].period);
+        }
+    }
+    lamda = uHighLowMode / (HardwareUtilization::one() - uLow);
+
+    currentTime = 0;
+    maxUtilization = curUtilization = targetUtilization = 0;
+    for (int i = 0; i < MAX_TASKS; i++) {
+        taskTable[i] = Entry();
+        readyQueue[i] = 0;
+    }
+    queueSize = 0;
+    currentCriticality = 0;
+    executed.assign(loaded, 0);
+    exeNum.assign(loaded, 0);
+    arrivals.reset(0);
+    arrivalTime.assign(loaded, 0);
+    arrived.assign(loaded, 0);
+    raised.assign(loaded, 0);
+    for (int i = 0; i < loaded; i++) {
+        if (tasks[i].arrival == Sporadic) {
+            arrivalTime[i] = tasks[i].firstArrival();
+            arrivals.add(arrivalTime[i], i);
+        }
+    }
+    return 0;
+}
+
+// The registers and the CPU side. timeBits belongs to the instance.
+void Skeleton::saveState(Snapshot &snapshot) const {
+    Scheduler::saveState(snapshot);
+    snapshot.put(loaded);
+    snapshot.put(lamda);
+    snapshot.put(currentTime);
+    snapshot.put(maxUtilization);
+    snapshot.put(curUtilization);
+    snapshot.put(targetUtilization);
+    snapshot.put(taskTable);
+    snapshot.put(readyQueue);
+    snapshot.put(queueSize);
+    snapshot.put(currentCriticality);
+    snapshot.put(executed);
+    snapshot.put(exeNum);
+    arrivals.save(snapshot);
+    snapshot.put(arrivalTime);
+    snapshot.put(arrived);
+    snapshot.put(raised);
+}
+
+void Skeleton::loadState(Snapshot &snapshot) {
+    Scheduler::loadState(snapshot);
+    snapshot.get(loaded);
+    snapshot.get(lamda);
+    snapshot.get(currentTime);
+    snapshot.get(maxUtilization);
+    snapshot.get(curUtilization);
+    snapshot.get(targetUtilization);
+    snapshot.get(taskTable);
+    snapshot.get(readyQueue);
+    snapshot.get(queueSize);
+    snapshot.get(currentCriticality);
+    snapshot.get(executed);
+    snapshot.get(exeNum);
+    arrivals.load(snapshot);
+    snapshot.get(arrivalTime);
+    snapshot.get(arrived);
+    snapshot.get(raised);
+}
+
+// What the testbench drives as input_task for task id. Virtual deadlines
+// shrink by lamda as in EDF-VD. A low task's utilization is its low mode
+// share, a high task's the share it adds in high mode, both out of
+// MAX_UTIL_PRECISION.
+Skeleton::Entry Skeleton::input(int id) const {
+    const Task &t = tasks[id];
+    Entry e = Entry();
+    e.valid = true;
+    e.taskType = t.arrival == Sporadic ? SPORADIC : PERIODIC;
+    e.criticality = t.crit == Low ? LOW : HIGH_LOW_MODE;
+    e.state = IDLE;
+    e.period = t.period & timeMask;
+    e.exLow = t.lowC & timeMask;
+    if (t.crit == Low) {
+        e.virtualDeadline = e.period;
+        e.exHigh = e.exLow;
+        e.utilization = (uint32_t) HardwareUtilization::ratio(t.lowC, t.period).raw() & UTIL_MASK;
+    } else {
+        e.virtualDeadline = lamda.scale(t.period) & timeMask;
+        e.exHigh = t.highC & timeMask;
+        e.utilization = (uint32_t) HardwareUtilization::ratio(t.highC - t.lowC, t.period).raw() & UTIL_MASK;
+    }
+    return e;
+}
+
+// The execution time of the current job of id. With a narrow time register
+// the wakeups wrap and release more jobs than the set holds, so it cycles.
+int Skeleton::need(int id) const {
+    const ExeTimeSource &exeTimes = tasks[id].exeTimes;
+    return exeTimes[exeNum[id] % exeTimes.size()];
+}
+
+void Skeleton::endJob(int id, bool success) {
+    TRACE(traceEvent(success ? TraceComplete : TraceMiss, id));
+    if (success) {
+        if (tasks[id].crit == Low) {
+            succeedLow++;
+        } else {
+            succeedHigh++;
+        }
+    } else {
+        if (tasks[id].crit == Low) {
+            failedLow++;
+        } else {
+            failedHigh++;
+        }
+    }
+    exeNum[id]++;
+    executed[id] = 0;
+}
+
+// One clock: always_comb on the registers and this clock's inputs, then the
+// posedge.
+int Skeleton::step(int time) {
+    STATS(stats.phase(Complete));
+    TRACE(traceTime(time));
+    bool inputValid = time < loaded;
+    int runningTask = readyQueue[0];
+    bool runningValid = taskTable[runningTask].state == READY;
+    bool completionValid = runningValid && executed[runningTask] >= need(runningTask);
+
+    for (int i = 0; i < MAX_TASKS; i++) {
+        nTaskTable[i] = taskTable[i];
+        nReadyQueue[i] = readyQueue[i];
+    }
+    uint32_t nTargetUtilization = targetUtilization;
+    uint32_t nCurUtilization = curUtilization;
+    bool insertValid = false;
+    int insertId = 0;
+    bool dropValid = false;
+    int dropIndex = 0;
+    bool criticalityTransition = false;
+    bool popValid = completionValid;
+    bool runningEnded = false;
+
+    // The testbench raises the lowest sporadic task with a job waiting.
+    STATS(stats.phase(Release));
+    due.clear();
+    arrivals.advance(time, [&](int i) {
+        due.push_back(i);
+    });
+    for (int i : due) {
+        arrived[i]++;
+        arrivalTime[i] += tasks[i].interArrival(arrived[i]);
+        arrivals.add(arrivalTime[i], i);
+    }
+    bool wakeupValid = false;
+    int wakeupId = 0;
+    for (int i = 0; i < loaded; i++) {
+        if (taskTable[i].valid && raised[i] < arrived[i] && raised[i] == exeNum[i]) {
+            wakeupValid = true;
+            wakeupId = i;
+            raised[i]++;
+            break;
+        }
+    }
+
+    if (inputValid) {
+        nTaskTable[time] = input(time);
+    }
+
+    // Wakeup periodic tasks. A dropped task wakeup_id makes low tasks skip
+    // their jobs.
+    for (int i = 0; i < MAX_TASKS; i++) {
+        const Entry &e = taskTable[i];
+        if (e.valid && e.taskType == PERIODIC && e.state == IDLE && e.wakeup <= currentTime) {
+            if (taskTable[wakeupId].state == DROPPED && e.criticality == LOW) {
+                nTaskTable[i].wakeup = (nTaskTable[i].wakeup + e.period) & timeMask;
+                endJob(i, false);
+            } else {
+                insertValid = true;
+                insertId = i;
+                break;
+            }
+        }
+    }
+
+    // Wakeup blocked tasks or interrupts, over the periodic task found.
+    if (wakeupValid) {
+        const Entry &e = taskTable[wakeupId];
+        if (e.state == DROPPED) {
+            nTaskTable[wakeupId].state = IDLE;
+            nTaskTable[wakeupId].exTime = 0;
+            if (e.taskType == PERIODIC) {
+                nTaskTable[wakeupId].wakeup = (nTaskTable[wakeupId].wakeup + e.period) & timeMask;
+            }
+            endJob(wakeupId, false);
+        } else if (e.state == BLOCKED || (e.state == IDLE && e.taskType == SPORADIC)) {
+            insertValid = true;
+            insertId = wakeupId;
+        }
+    }
+
+    // Handle removal of tasks from queue. Insertion already counts one clock
+    // of ex_time, so a non high-low job is popped one clock before it runs
+    // ex_low clocks, and fails if it needed all of them.
+    STATS(stats.phase(Miss));
+    const Entry &running = taskTable[runningTask];
+    if (completionValid ||
+        (runningValid && currentTime >= running.absoluteDeadline) ||
+        (runningValid && running.exTime >= running.exLow && running.criticality != HIGH_LOW_MODE) ||
+        (runningValid && running.state == DROPPED)) {
+        popValid = true;
+        nTaskTable[runningTask].state = IDLE;
+        nTaskTable[runningTask].exTime = 0;
+        if (running.taskType == PERIODIC) {
+            nTaskTable[runningTask].wakeup = (running.wakeup + running.period) & timeMask;
+        }
+        endJob(runningTask, completionValid);
+        runningEnded = true;
+    } else if (runningValid && running.exTime >= running.exLow && running.criticality == HIGH_LOW_MODE) {
+        nTaskTable[runningTask].criticality = HIGH_HIGH_MODE;
+        nTaskTable[runningTask].schedulingDeadline = running.absoluteDeadline;
+        nTaskTable[runningTask].exTime = (running.exTime + 1) & timeMask;
+        criticalityTransition = true;
+        TRACE(traceEvent(TraceModeSwitch, runningTask));
+        nTargetUtilization = (targetUtilization - running.utilization) & UTIL_MASK;
+    } else if (runningValid) {
+        nTaskTable[runningTask].exTime = (running.exTime + 1) & timeMask;
+    }
+
+    // Handle insertion of tasks to queue.
+    STATS(stats.phase(Dispatch));
+    STATS(stats.sampleQueue(queueSize));
+    if (insertValid) {
+        const Entry &e = taskTable[insertId];
+        Entry &n = nTaskTable[insertId];
+        uint32_t release = e.taskType == PERIODIC ? e.wakeup : currentTime;
+        n.absoluteDeadline = (release + e.period) & timeMask;
+        if (e.criticality == HIGH_LOW_MODE) {
+            n.schedulingDeadline = (release + e.virtualDeadline) & timeMask;
+        } else {
+            n.schedulingDeadline = (release + e.period) & timeMask;
+        }
+        n.state = READY;
+        n.exTime = (e.exTime + 1) & timeMask;
+        TRACE(traceEvent(TraceRelease, insertId));
+    }
+
+    // Actually add or remove from queue.
+    if (insertValid && popValid) {
+        for (int i = 1; i < MAX_TASKS; i++) {
+            if (i >= queueSize ||
+                taskTable[readyQueue[i]].schedulingDeadline > nTaskTable[insertId].schedulingDeadline) {
+                nReadyQueue[i - 1] = insertId;
+                break;
+            }
+            nReadyQueue[i - 1] = readyQueue[i];
+        }
+    } else if (insertValid) {
+        for (int i = MAX_TASKS - 1; i >= 0; i--) {
+            if (i == 0) {
+                nReadyQueue[i] = insertId;
+                break;
+            }
+            if (i <= queueSize &&
+                taskTable[readyQueue[i - 1]].schedulingDeadline <= nTaskTable[insertId].schedulingDeadline) {
+                nReadyQueue[i] = insertId;
+                break;
+            }
+            nReadyQueue[i] = readyQueue[i - 1];
+        }
+    } else if (popValid) {
+        for (int i = 1; i < MAX_TASKS; i++) {
+            nReadyQueue[i - 1] = readyQueue[i];
+        }
+    }
+
+    if (targetUtilization > curUtilization) {
+        for (int i = 0; i < MAX_TASKS; i++) {
+            const Entry &e = taskTable[i];
+            if (e.valid && e.criticality == LOW && e.state != DROPPED &&
+                (!dropValid || e.utilization > taskTable[dropIndex].utilization)) {
+                dropValid = true;
+                dropIndex = i;
+            }
+        }
+        if (dropValid) {
+            nTaskTable[dropIndex].state = DROPPED;
+            STATS(stats.dropped++);
+            TRACE(traceEvent(TraceDrop, dropIndex));
+        }
+    }
+
+    // The RTL leaves the last entry out of these two loops.
+    if (!runningValid && currentCriticality > 0) {
+        TRACE(traceEvent(TraceModeSwitch, -1));
+        for (int i = 0; i < MAX_TASKS - 1; i++) {
+            const Entry &e = taskTable[i];
+            if (e.valid && e.criticality == HIGH_HIGH_MODE) {
+                nTaskTable[i].criticality = HIGH_LOW_MODE;
+            } else if (e.valid && e.criticality == LOW && e.state == DROPPED) {
+                nTaskTable[i].state = IDLE;
+                STATS(stats.reenabled++);
+            }
+        }
+    }
+
+    if (currentTime & timeMsb) {
+        for (int i = 0; i < MAX_TASKS - 1; i++) {
+            nTaskTable[i].wakeup &= ~timeMsb;
+            nTaskTable[i].absoluteDeadline &= ~timeMsb;
+            nTaskTable[i].schedulingDeadline &= ~timeMsb;
+        }
+    }
+
+    // posedge clk, with en high.
+    STATS(stats.phase(Advance));
+    if (nReadyQueue[0] != readyQueue[0]) {
+        switches++;
+        TRACE(if (runningValid && !runningEnded) traceEvent(TracePreempt, runningTask));
+        TRACE(if (nTaskTable[nReadyQueue[0]].state == READY) traceEvent(TraceDispatch, nReadyQueue[0]));
+    }
+    uint32_t oldMaxUtilization = maxUtilization;
+    if (inputValid && tasks[time].crit == Low) {
+        uint32_t utilization = nTaskTable[time].utilization;
+        targetUtilization = (nTargetUtilization + utilization) & UTIL_MASK;
+        curUtilization = (nCurUtilization + utilization) & UTIL_MASK;
+        maxUtilization = (maxUtilization + utilization) & UTIL_MASK;
+    } else {
+        targetUtilization = nTargetUtilization;
+        curUtilization = nCurUtilization;
+    }
+    for (int i = 0; i < MAX_TASKS; i++) {
+        taskTable[i] = nTaskTable[i];
+        readyQueue[i] = nReadyQueue[i];
+    }
+    if (insertValid && !popValid) {
+        queueSize = (queueSize + 1) & TASK_MASK;
+    } else if (!insertValid && popValid) {
+        queueSize = (queueSize - 1) & TASK_MASK;
+    }
+    if (criticalityTransition) {
+        currentCriticality = (currentCriticality + 1) & TASK_MASK;
+        STATS(stats.modeSwitches++);
+    } else if (!runningValid) {
+        currentCriticality = 0;
+        curUtilization = oldMaxUtilization;
+        targetUtilization = oldMaxUtilization;
+    }
+    currentTime = currentTime & timeMsb ? 0 : currentTime + 1;
+
+    // The CPU ran the job at the head of the queue through this clock.
+    if (runningValid && !runningEnded) {
+        executed[runningTask]++;
+    }
+    return time + 1;
+}
@@ -0,0 +1,84 @@
+#include "Snapshot.h"
+
+#include <fstream>
+
+using namespace std;
+
+void Snapshot::put(const string &value) {
+    put(value.size());
+    putBytes(value.data(), value.size());
+}
+
+void Snapshot::get(string &value) {
+    value.resize(getSize());
+    getBytes(&value[0], value.size());
+}
+
+void Snapshot::rewind() {
+    readPos = 0;
+    failed = false;
+}
+
+bool Snapshot::good() const {
+    return !failed;
+}
+
+void Snapshot::fail() {
+    failed = true;
+}
+
+uint64_t Snapshot::hash() const {
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (char byte : bytes) {
+        h = (h ^ (unsigned char) byte) * 0x100000001b3ull;
+    }
+    return h;
+}
+
+bool Snapshot::operator==(const Snapshot &other) const {
+    return bytes == other.bytes;
+}
+
+bool Snapshot::write(const string &fileName) const {
+    ofstream file(fileName, ios::binary);
+    file.write(bytes.data(), bytes.size());
+    return file.good();
+}
+
+bool Snapshot::read(const string &fileName) {
+    ifstream file(fileName, ios::binary);
+    if (!file) {
+        return false;
+    }
+    bytes.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    rewind();
+    return !file.bad();
+}
+
+void Snapshot::putBytes(const void *data, size_t size) {
+    const char *begin = (const char *) data;
+    bytes.insert(bytes.end(), begin, begin + size);
+}
+
+void Snapshot::getBytes(void *data, size_t size) {
+    if (size > bytes.size() - readPos) {
+        failed = true;
+        readPos = bytes.size();
+        memset(data, 0, size);
+        return;
+    }
+    memcpy(data, bytes.data() + readPos, size);
+    readPos += size;
+}
+
+// A container size, never more than the bytes left could hold.
+size_t Snapshot::getSize() {
+    size_t size;
+    get(size);
+    if (size > bytes.size() - readPos) {
+        failed = true;
+        readPos = bytes.size();
+        return 0;
+    }
+    return size;
+}
@@ -0,0 +1,110 @@
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef SIMULATOR_SNAPSHOT_H
+#define SIMULATOR_SNAPSHOT_H
+
+// State saved as bytes, read back in the order it was put. Reading past the
+// end leaves zeroes and makes good() false. The bytes are those of the
+// machine that wrote them, so a file is only read back on the same platform.
+class Snapshot {
+public:
+    template <class T> void put(const T &value);
+    template <class T> void put(const std::vector<T> &values);
+    template <class T> void put(const std::set<T> &values);
+    template <class T, class U> void put(const std::pair<T, U> &value);
+    void put(const std::string &value);
+
+    template <class T> void get(T &value);
+    template <class T> void get(std::vector<T> &values);
+    template <class T> void get(std::set<T> &values);
+    template <class T, class U> void get(std::pair<T, U> &value);
+    void get(std::string &value);
+
+    // Reads from the start again, so one snapshot can be resumed many times.
+    void rewind();
+    bool good() const;
+    // Makes good() false, for a part read back that does not fit.
+    void fail();
+
+    // FNV-1a of the bytes put, to look equal snapshots up by.
+    uint64_t hash() const;
+    bool operator==(const Snapshot &other) const;
+
+    bool write(const std::string &fileName) const;
+    bool read(const std::string &fileName);
+
+private:
+    void putBytes(const void *data, size_t size);
+    void getBytes(void *data, size_t size);
+    size_t getSize();
+
+    std::vector<char> bytes;
+    size_t readPos = 0;
+    bool failed = false;
+};
+
+template <class T>
+void Snapshot::put(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are put as bytes");
+    putBytes(&value, sizeof(T));
+}
+
+template <class T>
+void Snapshot::put(const std::vector<T> &values) {
+    put(values.size());
+    for (const T &value : values) {
+        put(value);
+    }
+}
+
+template <class T>
+void Snapshot::put(const std::set<T> &values) {
+    put(values.size());
+    for (const T &value : values) {
+        put(value);
+    }
+}
+
+template <class T, class U>
+void Snapshot::put(const std::pair<T, U> &value) {
+    put(value.first);
+    put(value.second);
+}
+
+template <class T>
+void Snapshot::get(T &value) {
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values are got as bytes");
+    getBytes(&value, sizeof(T));
+}
+
+template <class T>
+void Snapshot::get(std::vector<T> &values) {
+    values.resize(getSize());
+    for (T &value : values) {
+        get(value);
+    }
+}
+
+template <class T>
+void Snapshot::get(std::set<T> &values) {
+    values.clear();
+    for (size_t n = getSize(); n > 0; n--) {
+        T value;
+        get(value);
+        values.insert(values.end(), value);
+    }
+}
+
+template <class T, class U>
+void Snapshot::get(std::pair<T, U> &value) {
+    get(value.first);
+    get(value.second);
+}
+
+#endif //SIMULATOR_SNAPSHOT_H
@@ -0,0 +1,264 @@
+#include "Sweep.h"
+
+#include <cmath>
+
+#include "Analysis.h"
+#include "Args.h"
+#include "Experiment.h"
+#include "TaskGen.h"
+
+using namespace std;
+
+namespace {
+
+struct Mean {
+    double sum = 0;
+    double squares = 0;
+    int n = 0;
+
+    void add(double x) {
+        sum += x;
+        squares += x * x;
+        n++;
+    }
+
+    double mean() const {
+        return n > 0 ? sum / n : 0;
+    }
+
+    double halfWidth() const {
+        if (n < 2) {
+            return 0;
+        }
+        double variance = max(0.0, (squares - sum * sum / n) / (n - 1));
+        return 1.96 * sqrt(variance / n);
+    }
+};
+
+}
+
+bool parseSweepArg(const string &arg, SweepGrid &grid) {
+    size_t eq = arg.find('=');
+    if (eq == string::npos) {
+        return false;
+    }
+    string name = arg.substr(0, eq);
+    string value = arg.substr(eq + 1);
+    if (name == "bound") {
+        return parseList(value, grid.bound);
+    } else if (name == "overrunP") {
+        return parseList(value, grid.overrunP);
+    } else if (name == "slackRatio") {
+        return parseList(value, grid.slackRatio);
+    } else if (name == "highP") {
+        return parseList(value, grid.highP);
+    } else if (name == "sets") {
+        return parseValue(value, grid.taskSetNum);
+    } else if (name == "clockPeriods") {
+        return parseValue(value, grid.clockPeriods);
+    } else if (name == "seed") {
+        return parseValue(value, grid.seed);
+    } else if (name == "steady") {
+        return parseValue(value, grid.steady);
+    } else if (name == "precision") {
+        return parseValue(value, grid.precision);
+    } else if (name == "jobs") {
+        return parseValue(value, grid.jobBudget);
+    } else if (name == "cores") {
+        return parseValue(value, grid.cores) && grid.cores >= 1;
+    } else if (name == "packing") {
+        return parsePacking(value, grid.packing);
+    } else if (name == "sporadicP") {
+        return parseValue(value, grid.sporadicP);
+    } else if (name == "maxDelay") {
+        return parseValue(value, grid.maxDelay) && grid.maxDelay >= 0;
+    } else if (name == "skeleton") {
+        return parseValue(value, grid.skeleton);
+    } else if (name == "analysis") {
+        return parseAnalysisMode(value, grid.analysis);
+    }
+    return false;
+}
+
+void analyzeSets(const vector<unique_ptr<TaskSet>> &taskSets, const vector<Scheduler*> &schedulers,
+                 AnalysisMode mode, vector<vector<Verdict>> &verdicts, vector<vector<bool>> &excluded,
+                 vector<vector<bool>> &skip) {
+    verdicts.clear();
+    excluded.clear();
+    skip.clear();
+    if (mode == AnalysisOff) {
+        return;
+    }
+    for (const unique_ptr<TaskSet> &taskSet : taskSets) {
+        Schedulability schedulability = analyze(taskSet->tasks, RUN_QUANTUM);
+        verdicts.emplace_back();
+        for (Scheduler* sch : schedulers) {
+            verdicts.back().push_back(verdict(schedulability, sch->getName()));
+        }
+        if (mode != AnalysisSkip) {
+            continue;
+        }
+        excluded.emplace_back();
+        skip.emplace_back();
+        for (int i = 0; i < schedulers.size(); i++) {
+            bool fails = verdicts.back()[i] == Fails && proven(schedulability, schedulers[i]->getName());
+            excluded.back().push_back(fails);
+            skip.back().push_back(fails && i > 0);
+        }
+    }
+}
+
+void runSweep(const SweepGrid &grid, int threadNum, ostream &out) {
+    vector<Scheduler*> schedulers = makeSchedulers(grid.cores, grid.packing, 1, grid.skeleton);
+    RunOptions options;
+    options.cores = grid.cores;
+    options.packing = grid.packing;
+    options.steady = grid.steady;
+    options.precision = grid.precision;
+    options.jobBudget = grid.jobBudget;
+    options.skeleton = grid.skeleton;
+    bool early = grid.precision > 0 || grid.jobBudget > 0;
+
+    out << "bound,overrunP,slackRatio,highP,sets";
+    for (Scheduler* sch : schedulers) {
+        const string &name = sch->getName();
+        out << ',' << name << " Low PFJ," << name << " Low CI," << name << " High PFJ," << name << " High CI,"
+            << name << " Switches";
+    }
+    if (grid.analysis != AnalysisOff) {
+        for (Scheduler* sch : schedulers) {
+            out << ',' << sch->getName() << " Analysis Passes";
+        }
+    }
+    if (grid.analysis == AnalysisSkip) {
+        for (Scheduler* sch : schedulers) {
+            out << ',' << sch->getName() << " Simulated";
+        }
+    }
+    if (early) {
+        for (Scheduler* sch : schedulers) {
+            const string &name = sch->getName();
+            out << ',' << name << " Ticks," << name << " Low Run CI," << name << " High Run CI";
+        }
+    }
+    if (grid.cores > 1) {
+        for (Scheduler* sch : schedulers) {
+            out << ',' << sch->getName() << " Migrations," << sch->getName() << " Core Utilization";
+        }
+    }
+    out << '\n';
+
+    for (float bound : grid.bound) {
+        for (float overrunP : grid.overrunP) {
+            for (float slackRatio : grid.slackRatio) {
+                for (float highP : grid.highP) {
+                    GenParams params;
+                    params.bound = bound * grid.cores;
+                    params.overrunP = overrunP;
+                    params.slackRatio = slackRatio;
+                    params.highP = highP;
+                    params.maxTasks *= grid.cores;
+                    params.clockPeriods = grid.clockPeriods;
+                    params.taskSetNum = grid.taskSetNum;
+                    params.sporadicP = grid.sporadicP;
+                    params.maxDelay = grid.maxDelay;
+
+                    vector<unique_ptr<TaskSet>> taskSets;
+                    for (int i = 0; i < grid.taskSetNum; i++) {
+                        unique_ptr<TaskSet> taskSet(new TaskSet());
+                        generateTaskSet(params, grid.seed, i, *taskSet);
+                        taskSets.push_back(move(taskSet));
+                    }
+
+                    vector<vector<Verdict>> verdicts;
+                    vector<vector<bool>> excluded, skip;
+                    analyzeSets(taskSets, schedulers, grid.analysis, verdicts, excluded, skip);
+
+                    vector<vector<Result>> results;
+                    runAll(taskSets, schedulers.size(), threadNum, results, skip, options);
+
+                    vector<Mean> lowPFJ(schedulers.size());
+                    vector<Mean> highPFJ(schedulers.size());
+                    vector<Mean> switchRatios(schedulers.size());
+                    vector<Mean> ticks(schedulers.size());
+                    vector<Mean> lowRunCI(schedulers.size());
+                    vector<Mean> highRunCI(schedulers.size());
+                    vector<Mean> migrations(schedulers.size());
+                    vector<Mean> coreUtilization(schedulers.size());
+                    for (int set = 0; set < results.size(); set++) {
+                        const vector<Result> &setResults = results[set];
+                        for (int i = 0; i < schedulers.size(); i++) {
+                            if (!excluded.empty() && excluded[set][i]) {
+                                continue;
+                            }
+                            lowPFJ[i].add(setResults[i].lowPFJ);
+                            highPFJ[i].add(setResults[i].highPFJ);
+                            switchRatios[i].add(switchRatio(setResults[i], setResults[0]));
+                            ticks[i].add(setResults[i].ticks);
+                            lowRunCI[i].add(setResults[i].lowHalfWidth);
+                            highRunCI[i].add(setResults[i].highHalfWidth);
+                            const vector<float> &utilizations = setResults[i].coreUtilizations;
+                            if (!utilizations.empty()) {
+                                migrations[i].add(setResults[i].migrations);
+                                double sum = 0;
+                                for (float u : utilizations) {
+                                    sum += u;
+                                }
+                                coreUtilization[i].add(sum / utilizations.size());
+                            }
+                        }
+                    }
+
+                    out << bound << ',' << overrunP << ',' << slackRatio << ',' << highP << ',' << grid.taskSetNum;
+                    for (int i = 0; i < schedulers.size(); i++) {
+                        // Left empty for a scheduler excluded from every set.
+                        if (lowPFJ[i].n == 0) {
+                            out << ",,,,,";
+                            continue;
+                        }
+                        out << ',' << lowPFJ[i].mean() << ',' << lowPFJ[i].halfWidth() << ',' << highPFJ[i].mean()
+                            << ',' << highPFJ[i].halfWidth() << ',' << switchRatios[i].mean();
+                    }
+                    if (grid.analysis != AnalysisOff) {
+                        for (int i = 0; i < schedulers.size(); i++) {
+                            int passes = 0;
+                            for (const vector<Verdict> &setVerdicts : verdicts) {
+                                passes += setVerdicts[i] == Passes;
+                            }
+                            out << ',';
+                            if (verdicts.empty() || verdicts[0][i] != Unanalyzed) {
+                                out << (double) passes / grid.taskSetNum;
+                            }
+                        }
+                    }
+                    if (grid.analysis == AnalysisSkip) {
+                        for (int i = 0; i < schedulers.size(); i++) {
+                            out << ',' << lowPFJ[i].n;
+                        }
+                    }
+                    if (early) {
+                        for (int i = 0; i < schedulers.size(); i++) {
+                            out << ',' << ticks[i].mean() << ',' << lowRunCI[i].mean() << ',' << highRunCI[i].mean();
+                        }
+                    }
+                    if (grid.cores > 1) {
+                        for (int i = 0; i < schedulers.size(); i++) {
+                            out << ',';
+                            if (migrations[i].n > 0) {
+                                out << migrations[i].mean() << ',' << coreUtilization[i].mean();
+                            } else {
+                                out << ',';
+                            }
+                        }
+                    }
+                    out << '\n';
+                    out.flush();
+                }
+            }
+        }
+    }
+
+    for (Scheduler* sch : schedulers) {
+        delete sch;
+    }
+}
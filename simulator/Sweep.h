@@ -0,0 +1,68 @@
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Analysis.h"
+#include "Partition.h"
+#include "TaskSet.h"
+
+#ifndef SIMULATOR_SWEEP_H
+#define SIMULATOR_SWEEP_H
+
+// Generation parameters to sweep. Every combination is a grid point, and every
+// grid point draws the same set indices from the same seed.
+struct SweepGrid {
+    std::vector<float> bound{0.9f};
+    std::vector<float> overrunP{.5f};
+    std::vector<float> slackRatio{1};
+    std::vector<float> highP{.5f};
+    int taskSetNum = 100;
+    int clockPeriods = 10000000;
+    uint64_t seed = 0;
+    AnalysisMode analysis = AnalysisOff;
+    // Runs with Scheduler::scheduleSteady, which skips the cycles of sets
+    // that settle into one.
+    bool steady = false;
+    // Stops every run early once its PFJs are this precise, or after this many
+    // jobs, see Scheduler::scheduleConverged. 0 runs to clockPeriods.
+    float precision = 0;
+    int jobBudget = 0;
+    // Partitions every set onto this many cores. bound is then per core, so
+    // sets have cores times the utilization and may have as many more tasks.
+    int cores = 1;
+    Packing packing = FirstFit;
+    // Draws this share of the tasks sporadic, with arrival delays of up to
+    // maxDelay periods.
+    float sporadicP = 0;
+    float maxDelay = .5f;
+    // Also runs SKELETON, on one core.
+    bool skeleton = false;
+};
+
+// Reads one "name=value[,value...]" argument into grid. Returns false for an
+// unknown name or a malformed value.
+bool parseSweepArg(const std::string &arg, SweepGrid &grid);
+
+// Analyzes every set for quantum RUN_QUANTUM into verdicts[set][scheduler].
+// With AnalysisSkip, excluded marks the sets each scheduler fails on a proven
+// verdict, which its means leave out, and skip the runs runAll can leave out:
+// the same but for the first scheduler, the base of the switch ratios, which
+// runs on every set so the others' ratios cover every set they ran. Both are
+// left empty otherwise.
+void analyzeSets(const std::vector<std::unique_ptr<TaskSet>> &taskSets, const std::vector<Scheduler*> &schedulers,
+                 AnalysisMode mode, std::vector<std::vector<Verdict>> &verdicts,
+                 std::vector<std::vector<bool>> &excluded, std::vector<std::vector<bool>> &skip);
+
+// Generates the task sets of every grid point in memory, runs all schedulers
+// on them and writes one CSV row per grid point: the mean Low and High PFJ of
+// every scheduler with the half-width of their 95% confidence interval, and
+// the mean switch ratio, all over the sets the scheduler was not excluded
+// from, then the analysis columns of grid.analysis. Runs
+// stopped early add the mean ticks simulated and mean half-widths of the
+// intervals they stopped on. Sweeps on several cores add the mean migrations
+// and mean core utilization of the schedulers that report them.
+void runSweep(const SweepGrid &grid, int threadNum, std::ostream &out);
+
+#endif //SIMULATOR_SWEEP_H
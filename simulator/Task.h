@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cstdint>
+
+#ifndef SIMULATOR_TASK_H
+#define SIMULATOR_TASK_H
+
+enum Criticality { Low, High };
+
+// Counter-based random numbers: the same (seed, task, job, draw) always gives
+// the same 32 bits, whatever else has been drawn before.
+inline uint32_t counterRandom(uint64_t seed, uint32_t task, uint32_t job, uint32_t draw) {
+    uint64_t z = seed ^ ((uint64_t) task << 32 | job) * 0x9E3779B97F4A7C15ull;
+    z += (uint64_t) (draw + 1) * 0xD1B54A32D192ED03ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (uint32_t) ((z ^ (z >> 31)) >> 32);
+}
+
+// The execution time distribution of taskGen: low tasks and non-overrunning
+// high tasks take [slackRatio * lowC, lowC), a high task overruns with
+// probability overrunP and then takes [max(lowC, slackRatio * highC), highC).
+struct ExeTimeModel {
+    uint64_t seed;
+    float overrunP;
+    float slackRatio;
+};
+
+// Execution times of a task's jobs. Either a view of stored times, which live
+// in the TaskSet the task was loaded from and have to outlive every copy, or
+// generated on demand from an ExeTimeModel keyed by (seed, task, job).
+class ExeTimeSource {
+public:
+    ExeTimeSource() = default;
+    ExeTimeSource(const int *data, int size) : data(data), count(size) {}
+    ExeTimeSource(const ExeTimeModel &model, int task, Criticality crit, int lowC, int highC, int size)
+            : count(size), model(model), task(task), crit(crit), lowC(lowC), highC(highC) {}
+
+    int operator[](int job) const { return data != nullptr ? data[job] : generate(job); }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Whether every job takes the same time.
+    bool constant() const {
+        if (data != nullptr) {
+            for (int job = 1; job < count; job++) {
+                if (data[job] != data[0]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        bool lowFixed = (int) (model.slackRatio * lowC) >= lowC;
+        bool highFixed = std::max(lowC, (int) (model.slackRatio * highC)) >= highC;
+        if (crit == Low || model.overrunP <= 0) {
+            return lowFixed;
+        }
+        if (model.overrunP >= 1) {
+            return highFixed;
+        }
+        return lowFixed && highFixed && lowC == highC;
+    }
+
+    int generate(int job) const {
+        int exeTime = randomInt(job, 0, (int) (model.slackRatio * lowC), lowC);
+        if (crit == High && randomFloat(job, 1) < model.overrunP) {
+            exeTime = randomInt(job, 2, std::max(lowC, (int) (model.slackRatio * highC)), highC);
+        }
+        return exeTime;
+    }
+
+private:
+    int randomInt(int job, int draw, int min, int max) const {
+        if (max <= min) {
+            return max;
+        }
+        return (int) (counterRandom(model.seed, task, job, draw) % (uint32_t) (max - min)) + min;
+    }
+
+    float randomFloat(int job, int draw) const {
+        return (float) (counterRandom(model.seed, task, job, draw) >> 8) / (float) (1u << 24);
+    }
+
+    const int *data = nullptr;
+    int count = 0;
+    ExeTimeModel model{};
+    int task = 0;
+    Criticality crit = Low;
+    int lowC = 0;
+    int highC = 0;
+};
+
+// How the jobs of a task arrive, as task_type in the RTL.
+enum Arrival { Periodic, Sporadic };
+
+// The arrival delays of taskGen: each job of a sporadic task arrives up to
+// maxDelay periods later than its minimum inter-arrival time allows.
+struct DelayModel {
+    uint64_t seed;
+    float maxDelay;
+};
+
+// Arrival delays of a sporadic task's jobs, stored or generated like
+// ExeTimeSource, uniform in [0, maxDelay * period] keyed by (seed, task, job).
+class DelaySource {
+public:
+    DelaySource() = default;
+    DelaySource(const int *data, int size) : data(data), count(size) {}
+    DelaySource(const DelayModel &model, int task, int period, int size)
+            : count(size), model(model), task(task), period(period) {}
+
+    int operator[](int job) const { return data != nullptr ? data[job] : generate(job); }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    int generate(int job) const {
+        int range = (int) (model.maxDelay * (float) period);
+        if (range <= 0) {
+            return 0;
+        }
+        return (int) (counterRandom(model.seed, task, job, 3) % (uint32_t) (range + 1));
+    }
+
+private:
+    const int *data = nullptr;
+    int count = 0;
+    DelayModel model{};
+    int task = 0;
+    int period = 0;
+};
+
+struct Task {
+    // For a sporadic task, the minimum inter-arrival time. Deadlines are
+    // implicit either way: a job is due one period after it arrives.
+    int period;
+    Criticality crit;
+    int lowC;
+    int highC;
+    ExeTimeSource exeTimes;
+    Arrival arrival = Periodic;
+    // Sporadic tasks only: job 0 arrives at delays[0], job j delays[j] past
+    // one period after job j - 1. Jobs past the stored ones arrive a period
+    // apart.
+    DelaySource delays;
+
+    int firstArrival() const {
+        return arrival == Sporadic && !delays.empty() ? delays[0] : 0;
+    }
+
+    // The time from the arrival of job - 1 to that of job.
+    int interArrival(int job) const {
+        return arrival == Sporadic && job < delays.size() ? period + delays[job] : period;
+    }
+};
+
+#endif //SIMULATOR_TASK_H
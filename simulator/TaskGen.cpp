@@ -0,0 +1,138 @@
+#include "TaskGen.h"
+
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+class SetRandom {
+public:
+    SetRandom(uint64_t seed, int index) : seed(seed), index(index) {}
+
+    uint32_t next() {
+        return counterRandom(seed, index, counter++, 0);
+    }
+
+    float randomFloat(float min, float max) {
+        if (abs(max - min) < .000001) {
+            return max;
+        }
+        return (float) (next() >> 8) / (float) (1u << 24) * (max - min) + min;
+    }
+
+    int randomInt(int min, int max) {
+        if (max <= min) {
+            return max;
+        }
+        return (int) (next() % (uint32_t) (max - min)) + min;
+    }
+
+private:
+    uint64_t seed;
+    int index;
+    uint32_t counter = 0;
+};
+
+}
+
+// Draws the execution time seed of tasks and which of them are sporadic, and
+// stores them in taskSet. The sporadic draws come last, so the rest of a set
+// does not depend on sporadicP.
+static void finishTaskSet(const GenParams &params, SetRandom &random, vector<Task> &tasks, TaskSet &taskSet) {
+    uint64_t exeSeed = (uint64_t) random.next() << 32 | random.next();
+    for (int j = 0; j < tasks.size(); j++) {
+        Task &t = tasks[j];
+        int jobs = params.clockPeriods / t.period + 1;
+        t.exeTimes = ExeTimeSource(ExeTimeModel{exeSeed, params.overrunP, params.slackRatio}, j, t.crit, t.lowC,
+                                   t.highC, jobs);
+        if (params.sporadicP > 0 && random.randomFloat(0, 1) < params.sporadicP) {
+            t.arrival = Sporadic;
+            t.delays = DelaySource(DelayModel{exeSeed, params.maxDelay}, j, t.period, jobs);
+        }
+    }
+
+    taskSet.clear();
+    taskSet.bound = params.bound;
+    taskSet.overrunP = params.overrunP;
+    taskSet.slackRatio = params.slackRatio;
+    taskSet.clockPeriods = params.clockPeriods;
+    taskSet.taskSetNum = params.taskSetNum;
+    taskSet.generated = true;
+    taskSet.seed = exeSeed;
+    taskSet.maxDelay = params.maxDelay;
+    taskSet.tasks = tasks;
+}
+
+void generateTaskSet(const GenParams &params, uint64_t seed, int index, TaskSet &taskSet) {
+    SetRandom random(seed, index);
+    vector<Task> tasks;
+
+    do {
+        tasks.clear();
+        float utilizationLow = 0.0f;
+        float utilizationHigh = 0.0f;
+
+        while (utilizationLow < params.bound - .05f && utilizationHigh < params.bound - .05f) {
+            Task t{};
+
+            float type = random.randomFloat(0, 1);
+            t.crit = type < params.highP ? High : Low;
+
+            type = random.randomFloat(0, 1);
+            float uLow;
+            if (type <= .5f) {
+                t.period = random.randomInt(200, 1000);
+                uLow = random.randomFloat(0.05f, .15f);
+            } else if (type <= 1) {
+                t.period = random.randomInt(1000, 100000);
+                uLow = random.randomFloat(0.01f, .05f);
+            } else {
+                t.period = random.randomInt(100000, 10000000);
+                uLow = random.randomFloat(0.005f, .01f);
+            }
+
+            t.lowC = (int) roundf(uLow * (float) t.period);
+
+            if (t.crit == High) {
+                t.highC = (int) roundf((float) t.lowC * random.randomFloat(1, 4));
+            } else {
+                t.highC = 0;
+            }
+
+            float uHigh = (float) t.highC / (float) t.period;
+            uLow = (float) t.lowC / (float) t.period;
+            if (uLow + utilizationLow < params.bound && uHigh + utilizationHigh < params.bound) {
+                utilizationHigh += uHigh;
+                utilizationLow += uLow;
+                tasks.emplace_back(t);
+            }
+        }
+    } while (tasks.size() > params.maxTasks);
+
+    finishTaskSet(params, random, tasks, taskSet);
+}
+
+void generateTaskSet(const GenParams &params, int taskNum, uint64_t seed, int index, TaskSet &taskSet) {
+    SetRandom random(seed, index);
+    vector<Task> tasks;
+
+    float sumU = params.bound;
+    for (int i = 0; i < taskNum; i++) {
+        Task t{};
+        t.crit = random.randomFloat(0, 1) < params.highP ? High : Low;
+        t.period = random.randomInt(200, 100000);
+
+        float uLow = sumU;
+        if (i < taskNum - 1) {
+            float nextSumU = sumU * powf(random.randomFloat(0, 1), 1.0f / (float) (taskNum - i - 1));
+            uLow = sumU - nextSumU;
+            sumU = nextSumU;
+        }
+        t.lowC = max(1, (int) roundf(uLow * (float) t.period));
+        t.highC = t.crit == High ? (int) roundf((float) t.lowC * random.randomFloat(1, 4)) : 0;
+        tasks.emplace_back(t);
+    }
+
+    finishTaskSet(params, random, tasks, taskSet);
+}
@@ -0,0 +1,34 @@
+#include <cstdint>
+
+#include "TaskSet.h"
+
+#ifndef SIMULATOR_TASKGEN_H
+#define SIMULATOR_TASKGEN_H
+
+struct GenParams {
+    float bound = 0.9f;
+    float overrunP = .5;
+    float slackRatio = 1;
+    float highP = .5;
+    int clockPeriods = 10000000;
+    int taskSetNum = 100;
+    // Sets with more tasks are drawn again.
+    int maxTasks = 32;
+    // The share of sporadic tasks, and how late their jobs may arrive, see
+    // DelayModel.
+    float sporadicP = 0;
+    float maxDelay = .5f;
+};
+
+// Draws set number index of a sweep into taskSet, with lazily generated
+// execution times. Every set has its own counter-based random stream, so the
+// result only depends on seed and index and sets can be drawn in any order
+// and on any number of threads.
+void generateTaskSet(const GenParams &params, uint64_t seed, int index, TaskSet &taskSet);
+
+// Like generateTaskSet but with exactly taskNum tasks, whose low mode
+// utilizations are split from params.bound with UUniFast. Used to scale task
+// sets far past what the utilization-driven generator produces.
+void generateTaskSet(const GenParams &params, int taskNum, uint64_t seed, int index, TaskSet &taskSet);
+
+#endif //SIMULATOR_TASKGEN_H
@@ -0,0 +1,100 @@
+#include "TaskMask.h"
+
+using namespace std;
+
+static int popCount(uint64_t bits) {
+#ifdef _MSC_VER
+    return (int) __popcnt64(bits);
+#else
+    return __builtin_popcountll(bits);
+#endif
+}
+
+void TaskMask::reset(int sizeIn) {
+    size = sizeIn;
+    bits.assign((size + 63) / 64, 0);
+    summary.assign((bits.size() + 63) / 64, 0);
+}
+
+void TaskMask::clear() {
+    for (uint64_t &word : bits) {
+        word = 0;
+    }
+    for (uint64_t &words : summary) {
+        words = 0;
+    }
+}
+
+void TaskMask::fill() {
+    for (int w = 0; w < bits.size(); w++) {
+        bits[w] = ~(uint64_t) 0;
+    }
+    if (size % 64 != 0) {
+        bits.back() = ((uint64_t) 1 << (size % 64)) - 1;
+    }
+    summarize();
+}
+
+bool TaskMask::empty() const {
+    for (uint64_t words : summary) {
+        if (words != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int TaskMask::count() const {
+    int n = 0;
+    for (uint64_t word : bits) {
+        n += popCount(word);
+    }
+    return n;
+}
+
+TaskMask &TaskMask::operator|=(const TaskMask &other) {
+    for (int w = 0; w < bits.size(); w++) {
+        bits[w] |= other.bits[w];
+    }
+    summarize();
+    return *this;
+}
+
+TaskMask &TaskMask::operator&=(const TaskMask &other) {
+    for (int w = 0; w < bits.size(); w++) {
+        bits[w] &= other.bits[w];
+    }
+    summarize();
+    return *this;
+}
+
+TaskMask &TaskMask::operator-=(const TaskMask &other) {
+    for (int w = 0; w < bits.size(); w++) {
+        bits[w] &= ~other.bits[w];
+    }
+    summarize();
+    return *this;
+}
+
+void TaskMask::summarize() {
+    for (uint64_t &words : summary) {
+        words = 0;
+    }
+    for (int w = 0; w < bits.size(); w++) {
+        if (bits[w] != 0) {
+            summary[w / 64] |= (uint64_t) 1 << (w % 64);
+        }
+    }
+}
+
+void TaskMask::save(Snapshot &snapshot) const {
+    snapshot.put(size);
+    snapshot.put(bits);
+    snapshot.put(summary);
+}
+
+void TaskMask::load(Snapshot &snapshot) {
+    snapshot.get(size);
+    snapshot.get(bits);
+    snapshot.get(summary);
+}
@@ -0,0 +1,142 @@
+#include <cstdint>
+#include <vector>
+
+#include "Snapshot.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifndef SIMULATOR_TASKMASK_H
+#define SIMULATOR_TASKMASK_H
+
+// A set of task ids kept as a bitmask, like the per-task state bits of the
+// hardware task table in scheduler/verilog. Ids 64w to 64w+63 share word w,
+// and bit w of the summary says word w is not empty, so walking a sparse set
+// of thousands of tasks skips empty words a summary word at a time.
+class TaskMask {
+public:
+    // Makes the set empty, over ids 0 to size-1.
+    void reset(int size);
+    void clear();
+    // Makes the set hold every id.
+    void fill();
+
+    // Saves or restores the whole state, see Snapshot.h.
+    void save(Snapshot &snapshot) const;
+    void load(Snapshot &snapshot);
+
+    bool empty() const;
+    int count() const;
+    bool contains(int id) const;
+    void insert(int id);
+    void erase(int id);
+
+    // The first id at or after from, or -1.
+    int next(int from) const;
+    int first() const;
+    // Calls f with every id in increasing order. Each word is read once before
+    // its ids are visited, so f may erase the id it is given.
+    template <class F> void forEach(F f) const;
+
+    int words() const;
+    uint64_t word(int w) const;
+    void setWord(int w, uint64_t bits);
+
+    TaskMask &operator|=(const TaskMask &other);
+    TaskMask &operator&=(const TaskMask &other);
+    // Removes the ids of other.
+    TaskMask &operator-=(const TaskMask &other);
+
+private:
+    void summarize();
+
+    int size = 0;
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> summary;
+};
+
+inline int lowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward64(&bit, bits);
+    return bit;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+inline bool TaskMask::contains(int id) const {
+    return bits[id / 64] >> (id % 64) & 1;
+}
+
+inline void TaskMask::insert(int id) {
+    bits[id / 64] |= (uint64_t) 1 << (id % 64);
+    summary[id / 4096] |= (uint64_t) 1 << (id / 64 % 64);
+}
+
+inline void TaskMask::erase(int id) {
+    bits[id / 64] &= ~((uint64_t) 1 << (id % 64));
+    if (bits[id / 64] == 0) {
+        summary[id / 4096] &= ~((uint64_t) 1 << (id / 64 % 64));
+    }
+}
+
+inline int TaskMask::next(int from) const {
+    int w = from / 64;
+    if (w >= bits.size()) {
+        return -1;
+    }
+    uint64_t found = bits[w] & ~(uint64_t) 0 << (from % 64);
+    if (found != 0) {
+        return w * 64 + lowestBit(found);
+    }
+    // The next non-empty word, from the summary.
+    w++;
+    for (int s = w / 64; s < summary.size(); s++) {
+        uint64_t words = summary[s];
+        if (s == w / 64) {
+            words &= ~(uint64_t) 0 << (w % 64);
+        }
+        if (words != 0) {
+            w = s * 64 + lowestBit(words);
+            return w * 64 + lowestBit(bits[w]);
+        }
+    }
+    return -1;
+}
+
+inline int TaskMask::first() const {
+    return next(0);
+}
+
+template <class F>
+void TaskMask::forEach(F f) const {
+    for (int s = 0; s < summary.size(); s++) {
+        for (uint64_t words = summary[s]; words != 0; words &= words - 1) {
+            int w = s * 64 + lowestBit(words);
+            for (uint64_t word = bits[w]; word != 0; word &= word - 1) {
+                f(w * 64 + lowestBit(word));
+            }
+        }
+    }
+}
+
+inline int TaskMask::words() const {
+    return bits.size();
+}
+
+inline uint64_t TaskMask::word(int w) const {
+    return bits[w];
+}
+
+inline void TaskMask::setWord(int w, uint64_t word) {
+    bits[w] = word;
+    if (word != 0) {
+        summary[w / 64] |= (uint64_t) 1 << (w % 64);
+    } else {
+        summary[w / 64] &= ~((uint64_t) 1 << (w % 64));
+    }
+}
+
+#endif //SIMULATOR_TASKMASK_H
@@ -0,0 +1,345 @@
+#include "TaskSet.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// exeTimes views point straight at the int32 arrays in the file.
+static_assert(sizeof(int) == sizeof(int32_t), "int must be 32 bits");
+
+static const size_t VERSION_1_HEADER_SIZE = offsetof(TaskSetHeader, flags);
+
+static void *mapFile(const string &fileName, size_t &size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER fileSize;
+    void *data = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        size = (size_t) fileSize.QuadPart;
+    }
+    CloseHandle(file);
+    return data;
+#else
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st{};
+    void *data = nullptr;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            data = nullptr;
+        }
+        size = st.st_size;
+    }
+    close(fd);
+    return data;
+#endif
+}
+
+static void unmapFile(void *data, size_t size) {
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+TaskSet::~TaskSet() {
+    clear();
+}
+
+void TaskSet::clear() {
+    generated = false;
+    seed = 0;
+    maxDelay = 0.0f;
+    tasks.clear();
+    storage.clear();
+    if (mapping != nullptr) {
+        unmapFile(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+}
+
+bool TaskSet::load(const string &path) {
+    ifstream binary(path + ".bin");
+    if (binary.good()) {
+        return loadBinary(path + ".bin");
+    }
+    return loadText(path + ".txt");
+}
+
+bool TaskSet::loadBinary(const string &fileName) {
+    clear();
+    mapping = mapFile(fileName, mappingSize);
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    const char *data = (const char *) mapping;
+    TaskSetHeader header{};
+    if (mappingSize < VERSION_1_HEADER_SIZE) {
+        clear();
+        return false;
+    }
+    memcpy(&header, data, VERSION_1_HEADER_SIZE);
+    size_t headerSize = header.version == 1 ? VERSION_1_HEADER_SIZE : sizeof(header);
+    if (memcmp(header.magic, TASK_SET_MAGIC, sizeof(header.magic)) != 0 || header.version < 1 ||
+        header.version > TASK_SET_VERSION || header.numTasks < 0 ||
+        mappingSize < headerSize + header.numTasks * sizeof(TaskRecord)) {
+        clear();
+        return false;
+    }
+    memcpy(&header, data, headerSize);
+
+    bound = header.bound;
+    overrunP = header.overrunP;
+    slackRatio = header.slackRatio;
+    clockPeriods = header.clockPeriods;
+    taskSetNum = header.taskSetNum;
+    generated = (header.flags & TASK_SET_GENERATED) != 0;
+    seed = header.seed;
+    maxDelay = header.version >= 3 ? header.maxDelay : 0.0f;
+
+    const char *recordData = data + headerSize;
+    for (int i = 0; i < header.numTasks; i++) {
+        TaskRecord record{};
+        memcpy(&record, recordData + i * sizeof(TaskRecord), sizeof(record));
+        Arrival arrival = header.version >= 3 && record.arrival == Sporadic ? Sporadic : Periodic;
+        int64_t stored = (int64_t) record.exeCount * (arrival == Sporadic ? 2 : 1);
+        if (record.exeCount < 0 || (!generated && (record.exeOffset < 0 || record.exeOffset % sizeof(int32_t) != 0 ||
+            record.exeOffset + stored * (int64_t) sizeof(int32_t) > (int64_t) mappingSize))) {
+            clear();
+            return false;
+        }
+        Task t;
+        t.period = record.period;
+        t.crit = record.crit == High ? High : Low;
+        t.lowC = record.lowC;
+        t.highC = record.highC;
+        t.arrival = arrival;
+        if (generated) {
+            t.exeTimes = ExeTimeSource(ExeTimeModel{seed, overrunP, slackRatio}, i, t.crit, t.lowC, t.highC,
+                                       record.exeCount);
+            if (arrival == Sporadic) {
+                t.delays = DelaySource(DelayModel{seed, maxDelay}, i, t.period, record.exeCount);
+            }
+        } else {
+            const int *times = (const int *) (data + record.exeOffset);
+            t.exeTimes = ExeTimeSource(times, record.exeCount);
+            if (arrival == Sporadic) {
+                t.delays = DelaySource(times + record.exeCount, record.exeCount);
+            }
+        }
+        tasks.push_back(t);
+    }
+    return true;
+}
+
+bool TaskSet::loadText(const string &fileName) {
+    clear();
+    ifstream file(fileName);
+    string line;
+    getline(file, line);
+
+    istringstream header(line);
+    int numTasks;
+    if (!(header >> bound >> overrunP >> slackRatio >> clockPeriods >> taskSetNum >> numTasks)) {
+        return false;
+    }
+    generated = (bool) (header >> seed);
+    if (generated && !(header >> maxDelay)) {
+        maxDelay = 0.0f;
+    }
+
+    vector<int> counts;
+
+    for (int i = 0; i < numTasks; i++) {
+        getline(file, line);
+
+        istringstream iss(line);
+
+        Task t;
+
+        char crit;
+        iss >> t.period >> crit >> t.lowC >> t.highC >> ws;
+        t.crit = crit == 'L' ? Low : High;
+        if (iss.peek() == 'S') {
+            iss.get();
+            t.arrival = Sporadic;
+        }
+        int count = 0;
+        int val;
+        while (iss >> val) {
+            storage.push_back(val);
+            count++;
+        }
+        tasks.push_back(t);
+        counts.push_back(count);
+    }
+
+    // Only point into storage once it has stopped growing.
+    int offset = 0;
+    for (int i = 0; i < tasks.size(); i++) {
+        Task &t = tasks[i];
+        if (generated) {
+            int jobs = clockPeriods / t.period + 1;
+            t.exeTimes = ExeTimeSource(ExeTimeModel{seed, overrunP, slackRatio}, i, t.crit, t.lowC, t.highC, jobs);
+            if (t.arrival == Sporadic) {
+                t.delays = DelaySource(DelayModel{seed, maxDelay}, i, t.period, jobs);
+            }
+        } else if (t.arrival == Sporadic) {
+            t.exeTimes = ExeTimeSource(storage.data() + offset, counts[i] / 2);
+            t.delays = DelaySource(storage.data() + offset + counts[i] / 2, counts[i] / 2);
+        } else {
+            t.exeTimes = ExeTimeSource(storage.data() + offset, counts[i]);
+        }
+        offset += counts[i];
+    }
+    return true;
+}
+
+bool TaskSet::saveBinary(const string &fileName) const {
+    TaskSetWriter writer;
+    if (!writer.open(fileName, bound, overrunP, slackRatio, clockPeriods, taskSetNum, tasks.size(), generated, seed,
+                     maxDelay)) {
+        return false;
+    }
+    for (const Task &t: tasks) {
+        writer.addTask(t);
+    }
+    return writer.close();
+}
+
+bool TaskSet::saveText(const string &fileName) const {
+    ofstream file(fileName);
+
+    file << bound << " " << overrunP << " " << slackRatio << " " << clockPeriods << " " << taskSetNum << " " << tasks.size();
+    if (generated) {
+        file << " " << seed;
+        for (const Task &t : tasks) {
+            if (t.arrival == Sporadic) {
+                file << " " << maxDelay;
+                break;
+            }
+        }
+    }
+    file << '\n';
+
+    for (const Task &t: tasks) {
+        file << t.period << (t.crit == Low ? " L " : " H ") << t.lowC << " " << t.highC;
+        if (t.arrival == Sporadic) {
+            file << " S";
+        }
+        for (int job = 0; !generated && job < t.exeTimes.size(); job++) {
+            file << " " << t.exeTimes[job];
+        }
+        for (int job = 0; !generated && t.arrival == Sporadic && job < t.exeTimes.size(); job++) {
+            file << " " << t.interArrival(job) - t.period;
+        }
+        file << '\n';
+    }
+    file.close();
+    return !file.fail();
+}
+
+TaskSetWriter::~TaskSetWriter() {
+    close();
+}
+
+bool TaskSetWriter::open(const string &fileName, float bound, float overrunP, float slackRatio, int clockPeriods,
+                         int taskSetNum, int numTasks, bool generated, uint64_t seed, float maxDelay) {
+    close();
+    file = fopen(fileName.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    TaskSetHeader header{};
+    memcpy(header.magic, TASK_SET_MAGIC, sizeof(header.magic));
+    header.version = TASK_SET_VERSION;
+    header.bound = bound;
+    header.overrunP = overrunP;
+    header.slackRatio = slackRatio;
+    header.clockPeriods = clockPeriods;
+    header.taskSetNum = taskSetNum;
+    header.numTasks = numTasks;
+    header.flags = generated ? TASK_SET_GENERATED : 0;
+    header.maxDelay = maxDelay;
+    header.seed = seed;
+
+    // The task table is written by close, once every offset is known.
+    records.clear();
+    records.reserve(numTasks);
+    offset = sizeof(header) + numTasks * sizeof(TaskRecord);
+    ok = fwrite(&header, sizeof(header), 1, file) == 1 && fseek(file, offset, SEEK_SET) == 0;
+    expected = numTasks;
+    this->generated = generated;
+    return ok;
+}
+
+void TaskSetWriter::addTask(const Task &t) {
+    if (file == nullptr) {
+        return;
+    }
+    TaskRecord record{};
+    record.period = t.period;
+    record.crit = t.crit;
+    record.lowC = t.lowC;
+    record.highC = t.highC;
+    record.exeCount = t.exeTimes.size();
+    record.arrival = t.arrival;
+    if (generated) {
+        records.push_back(record);
+        return;
+    }
+    record.exeOffset = offset;
+    records.push_back(record);
+
+    // A sporadic task's delays follow its times.
+    buffer.resize(t.arrival == Sporadic ? 2 * t.exeTimes.size() : t.exeTimes.size());
+    for (int job = 0; job < t.exeTimes.size(); job++) {
+        buffer[job] = t.exeTimes[job];
+    }
+    for (int job = t.exeTimes.size(); job < buffer.size(); job++) {
+        buffer[job] = t.interArrival(job - t.exeTimes.size()) - t.period;
+    }
+    if (!buffer.empty()) {
+        ok = ok && fwrite(buffer.data(), sizeof(int32_t), buffer.size(), file) == buffer.size();
+    }
+    offset += buffer.size() * sizeof(int32_t);
+}
+
+bool TaskSetWriter::close() {
+    if (file == nullptr) {
+        return false;
+    }
+    ok = ok && records.size() == expected && fseek(file, sizeof(TaskSetHeader), SEEK_SET) == 0 &&
+         (records.empty() || fwrite(records.data(), sizeof(TaskRecord), records.size(), file) == records.size());
+    ok = fclose(file) == 0 && ok;
+    file = nullptr;
+    return ok;
+}
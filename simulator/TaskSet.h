@@ -0,0 +1,112 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Task.h"
+
+#ifndef SIMULATOR_TASKSET_H
+#define SIMULATOR_TASKSET_H
+
+// Binary task set file in the byte order of the machine that wrote it: a
+// TaskSetHeader, numTasks TaskRecords, then the execution times of every task
+// as contiguous int32 arrays at the offsets given in their records, each
+// sporadic task's followed by as many arrival delays. Version 1 headers end
+// before flags, and before version 3 every task is periodic. With
+// TASK_SET_GENERATED no times are stored and they are generated from seed
+// instead, the delays with maxDelay, exeCount is then the number of jobs.
+const char TASK_SET_MAGIC[4] = {'T', 'S', 'E', 'T'};
+const int32_t TASK_SET_VERSION = 3;
+const int32_t TASK_SET_GENERATED = 1;
+
+struct TaskSetHeader {
+    char magic[4];
+    int32_t version;
+    float bound;
+    float overrunP;
+    float slackRatio;
+    int32_t clockPeriods;
+    int32_t taskSetNum;
+    int32_t numTasks;
+    int32_t flags;
+    float maxDelay;
+    uint64_t seed;
+};
+
+struct TaskRecord {
+    int32_t period;
+    int32_t crit;
+    int32_t lowC;
+    int32_t highC;
+    int64_t exeOffset;
+    int32_t exeCount;
+    int32_t arrival;
+};
+
+// A task set loaded from either format. Binary files are memory mapped and the
+// tasks' exeTimes point straight into the mapping, text files are parsed into
+// one contiguous buffer. A text file whose header ends in a seed has no times
+// on its task lines and, like a generated binary file, draws them on demand,
+// and maxDelay may follow the seed. A sporadic task's line has an S after
+// highC, and its times are followed by as many arrival delays.
+class TaskSet {
+public:
+    TaskSet() = default;
+    TaskSet(const TaskSet &) = delete;
+    TaskSet &operator=(const TaskSet &) = delete;
+    ~TaskSet();
+
+    // Loads path + ".bin" if it exists and path + ".txt" otherwise.
+    bool load(const std::string &path);
+    bool loadBinary(const std::string &fileName);
+    bool loadText(const std::string &fileName);
+    bool saveBinary(const std::string &fileName) const;
+    bool saveText(const std::string &fileName) const;
+    void clear();
+
+    float bound = 0.0f;
+    float overrunP = 0.0f;
+    float slackRatio = 0.0f;
+    int clockPeriods = 0;
+    int taskSetNum = 0;
+    // Execution times are drawn from seed and not stored, saving a set stores
+    // them when this is cleared.
+    bool generated = false;
+    uint64_t seed = 0;
+    // Generated sporadic tasks' arrival delays, see DelayModel.
+    float maxDelay = 0.0f;
+    std::vector<Task> tasks;
+
+private:
+    std::vector<int> storage;
+    void *mapping = nullptr;
+    size_t mappingSize = 0;
+};
+
+// Writes a binary task set one task at a time, for generators that do not keep
+// the whole set in memory.
+class TaskSetWriter {
+public:
+    TaskSetWriter() = default;
+    TaskSetWriter(const TaskSetWriter &) = delete;
+    TaskSetWriter &operator=(const TaskSetWriter &) = delete;
+    ~TaskSetWriter();
+
+    // A generated set stores only seed and maxDelay, its tasks' times are not
+    // written.
+    bool open(const std::string &fileName, float bound, float overrunP, float slackRatio, int clockPeriods,
+              int taskSetNum, int numTasks, bool generated = false, uint64_t seed = 0, float maxDelay = 0);
+    void addTask(const Task &t);
+    bool close();
+
+private:
+    FILE *file = nullptr;
+    std::vector<TaskRecord> records;
+    int64_t offset = 0;
+    int expected = 0;
+    bool generated = false;
+    std::vector<int> buffer;
+    bool ok = false;
+};
+
+#endif //SIMULATOR_TASKSET_H
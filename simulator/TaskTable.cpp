@@ -0,0 +1,67 @@
+#include "TaskTable.h"
+
+#include <climits>
+
+using namespace std;
+
+// Timer values: a task's wakeup is 2 * id, its deadline 2 * id + 1.
+
+void TaskTable::reset(int size) {
+    wakeupTime.assign(size, INT_MAX);
+    absoluteDeadline.assign(size, INT_MAX);
+    exeTime.assign(size, 0);
+    limit.assign(size, INT_MAX);
+    timers.reset(0);
+    dueTasks.reset(size);
+    lateTasks.reset(size);
+}
+
+int TaskTable::size() const {
+    return wakeupTime.size();
+}
+
+void TaskTable::sleep(int id) {
+    dueTasks.erase(id);
+    lateTasks.erase(id);
+    timers.add(wakeupTime[id], 2 * id);
+}
+
+void TaskTable::wake(int id) {
+    dueTasks.erase(id);
+    timers.add(absoluteDeadline[id] + 1, 2 * id + 1);
+}
+
+// A timer can be left over from an earlier job, so each is checked against the
+// task as it is now.
+void TaskTable::advance(int time, const TaskMask &idle) {
+    timers.advance(time, [&](int timer) {
+        int id = timer / 2;
+        if (timer % 2 == 0) {
+            if (idle.contains(id) && time >= wakeupTime[id]) {
+                dueTasks.insert(id);
+            }
+        } else if (!idle.contains(id) && time > absoluteDeadline[id]) {
+            lateTasks.insert(id);
+        }
+    });
+}
+
+void TaskTable::save(Snapshot &snapshot) const {
+    snapshot.put(wakeupTime);
+    snapshot.put(absoluteDeadline);
+    snapshot.put(exeTime);
+    snapshot.put(limit);
+    timers.save(snapshot);
+    dueTasks.save(snapshot);
+    lateTasks.save(snapshot);
+}
+
+void TaskTable::load(Snapshot &snapshot) {
+    snapshot.get(wakeupTime);
+    snapshot.get(absoluteDeadline);
+    snapshot.get(exeTime);
+    snapshot.get(limit);
+    timers.load(snapshot);
+    dueTasks.load(snapshot);
+    lateTasks.load(snapshot);
+}
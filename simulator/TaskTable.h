@@ -0,0 +1,56 @@
+#include <vector>
+
+#include "Snapshot.h"
+#include "TaskMask.h"
+#include "TimerWheel.h"
+
+#ifndef SIMULATOR_TASKTABLE_H
+#define SIMULATOR_TASKTABLE_H
+
+// The per-task times, one contiguous array each, and a timer wheel with the
+// next wakeup of every idle task and the deadline of every other, so a tick
+// only looks at the tasks whose timers fired. Which tasks are idle is kept
+// apart, as a TaskMask; the table is told when a task goes idle or wakes.
+class TaskTable {
+public:
+    // Clears the timers; each task is then put to sleep or woken.
+    void reset(int size);
+    int size() const;
+
+    // Saves or restores the whole state, see Snapshot.h.
+    void save(Snapshot &snapshot) const;
+    void load(Snapshot &snapshot);
+
+    // Task id went idle until its wakeup time.
+    void sleep(int id);
+    // Task id has a job again, due by its absolute deadline.
+    void wake(int id);
+
+    // Fires the timers up to time, adding to due the tasks in idle that are
+    // due to wake up and to late those not in idle that missed their deadline.
+    // Both keep a task until it wakes or sleeps.
+    void advance(int time, const TaskMask &idle);
+    const TaskMask &due() const;
+    const TaskMask &late() const;
+
+    std::vector<int> wakeupTime;
+    std::vector<int> absoluteDeadline;
+    std::vector<int> exeTime;
+    // Execution time past which the job fails, INT_MAX for none.
+    std::vector<int> limit;
+
+private:
+    TimerWheel timers;
+    TaskMask dueTasks;
+    TaskMask lateTasks;
+};
+
+inline const TaskMask &TaskTable::due() const {
+    return dueTasks;
+}
+
+inline const TaskMask &TaskTable::late() const {
+    return lateTasks;
+}
+
+#endif //SIMULATOR_TASKTABLE_H
@@ -0,0 +1,93 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+using namespace std;
+
+void TimerWheel::reset(int nowIn) {
+    now = nowIn;
+    count = 0;
+    for (int level = 0; level < LEVELS; level++) {
+        for (uint64_t bits = occupied[level]; bits != 0; bits &= bits - 1) {
+            slots[level][lowestBit(bits)].clear();
+        }
+        occupied[level] = 0;
+    }
+    expired.clear();
+}
+
+bool TimerWheel::empty() const {
+    return count == 0;
+}
+
+void TimerWheel::add(int time, int value) {
+    count++;
+    place(Timer{time, value});
+}
+
+int TimerWheel::earliest() const {
+    int first = INT32_MAX;
+    for (const Timer &timer : expired) {
+        first = min(first, timer.time);
+    }
+    if (!expired.empty()) {
+        return first;
+    }
+    int level = 0;
+    while (occupied[level] == 0) {
+        level++;
+    }
+    int slot = lowestBit(occupied[level]);
+    if (level == 0) {
+        return slotStart(level, slot);
+    }
+    for (const Timer &timer : slots[level][slot]) {
+        first = min(first, timer.time);
+    }
+    return first;
+}
+
+void TimerWheel::place(const Timer &timer) {
+    if (timer.time <= now) {
+        expired.push_back(timer);
+        return;
+    }
+    // The highest digit in which time and now differ picks the level.
+    uint64_t differ = (uint64_t) timer.time ^ (uint64_t) now;
+    int level = 0;
+    while (differ >> 6 * (level + 1) != 0) {
+        level++;
+    }
+    int slot = timer.time >> 6 * level & 63;
+    slots[level][slot].push_back(timer);
+    occupied[level] |= (uint64_t) 1 << slot;
+}
+
+long long TimerWheel::slotStart(int level, int slot) const {
+    int shift = 6 * (level + 1);
+    return (now >> shift << shift) + ((long long) slot << 6 * level);
+}
+
+void TimerWheel::save(Snapshot &snapshot) const {
+    snapshot.put(now);
+    snapshot.put(count);
+    snapshot.put(occupied);
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < 64; slot++) {
+            snapshot.put(slots[level][slot]);
+        }
+    }
+    snapshot.put(expired);
+}
+
+void TimerWheel::load(Snapshot &snapshot) {
+    snapshot.get(now);
+    snapshot.get(count);
+    snapshot.get(occupied);
+    for (int level = 0; level < LEVELS; level++) {
+        for (int slot = 0; slot < 64; slot++) {
+            snapshot.get(slots[level][slot]);
+        }
+    }
+    snapshot.get(expired);
+}
@@ -0,0 +1,87 @@
+#include <cstdint>
+#include <vector>
+
+#include "Snapshot.h"
+#include "TaskMask.h"
+
+#ifndef SIMULATOR_TIMERWHEEL_H
+#define SIMULATOR_TIMERWHEEL_H
+
+// Hierarchical timer wheel of (time, value) timers. Level k has 64 slots of
+// 64^k ticks each and holds the timers that share every digit above k with
+// now, so each level is later than the one below it. Advancing only visits
+// occupied slots, and moves the timers of a higher slot down once now
+// reaches it.
+class TimerWheel {
+public:
+    void reset(int now);
+
+    // Saves or restores the whole state, see Snapshot.h.
+    void save(Snapshot &snapshot) const;
+    void load(Snapshot &snapshot);
+    bool empty() const;
+
+    // A timer at or before now fires on the next advance.
+    void add(int time, int value);
+    // Moves now to time and calls fire(value) for every timer at or before
+    // it. fire must not add timers.
+    template <class F> void advance(int time, F fire);
+    // The time of the earliest timer. The wheel must not be empty.
+    int earliest() const;
+
+private:
+    static const int LEVELS = 6;
+
+    struct Timer {
+        int time;
+        int value;
+    };
+
+    void place(const Timer &timer);
+    long long slotStart(int level, int slot) const;
+
+    long long now = 0;
+    int count = 0;
+    uint64_t occupied[LEVELS] = {};
+    std::vector<Timer> slots[LEVELS][64];
+    std::vector<Timer> expired;
+    std::vector<Timer> moving;
+};
+
+template <class F>
+void TimerWheel::advance(int time, F fire) {
+    for (const Timer &timer : expired) {
+        fire(timer.value);
+    }
+    count -= expired.size();
+    expired.clear();
+
+    while (count > 0) {
+        int level = 0;
+        while (occupied[level] == 0) {
+            level++;
+        }
+        int slot = lowestBit(occupied[level]);
+        long long start = slotStart(level, slot);
+        if (start > time) {
+            break;
+        }
+        now = start;
+        occupied[level] &= ~((uint64_t) 1 << slot);
+        moving.swap(slots[level][slot]);
+        for (const Timer &timer : moving) {
+            if (timer.time <= now) {
+                count--;
+                fire(timer.value);
+            } else {
+                place(timer);
+            }
+        }
+        moving.clear();
+    }
+    if (time > now) {
+        now = time;
+    }
+}
+
+#endif //SIMULATOR_TIMERWHEEL_H
@@ -0,0 +1,132 @@
+#include "Trace.h"
+
+#include <cstring>
+
+using namespace std;
+
+TraceWriter::TraceWriter(const string &fileName, const string &scheduler) {
+    file = fopen(fileName.c_str(), "wb");
+    if (file == nullptr) {
+        return;
+    }
+    buffer.resize(BUFFER_SIZE);
+    pending.resize(BUFFER_SIZE);
+    fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file);
+    put(scheduler.size());
+    fwrite(buffer.data(), 1, used, file);
+    fwrite(scheduler.data(), 1, scheduler.size(), file);
+    used = 0;
+    writer = thread(&TraceWriter::writeLoop, this);
+}
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+bool TraceWriter::good() const {
+    return file != nullptr;
+}
+
+void TraceWriter::close() {
+    if (file == nullptr) {
+        return;
+    }
+    flush();
+    {
+        lock_guard<mutex> guard(lock);
+        closing = true;
+    }
+    changed.notify_all();
+    writer.join();
+    fclose(file);
+    file = nullptr;
+}
+
+// Hands the buffer to the writing thread, once it is done with the last one.
+void TraceWriter::flush() {
+    if (file == nullptr) {
+        used = 0;
+        return;
+    }
+    unique_lock<mutex> guard(lock);
+    changed.wait(guard, [&]() { return !hasPending; });
+    buffer.swap(pending);
+    pending.resize(used);
+    buffer.resize(BUFFER_SIZE);
+    used = 0;
+    hasPending = true;
+    guard.unlock();
+    changed.notify_all();
+}
+
+void TraceWriter::writeLoop() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        changed.wait(guard, [&]() { return hasPending || closing; });
+        if (!hasPending) {
+            return;
+        }
+        guard.unlock();
+        fwrite(pending.data(), 1, pending.size(), file);
+        guard.lock();
+        hasPending = false;
+        changed.notify_all();
+    }
+}
+
+TraceReader::TraceReader(const string &fileName) {
+    file = fopen(fileName.c_str(), "rb");
+    if (file == nullptr) {
+        return;
+    }
+    char magic[sizeof(TRACE_MAGIC)];
+    uint64_t length;
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+        memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 || !get(length)) {
+        return;
+    }
+    scheduler.resize(length);
+    valid = fread(&scheduler[0], 1, length, file) == length;
+}
+
+TraceReader::~TraceReader() {
+    if (file != nullptr) {
+        fclose(file);
+    }
+}
+
+bool TraceReader::good() const {
+    return valid;
+}
+
+const string &TraceReader::getScheduler() const {
+    return scheduler;
+}
+
+bool TraceReader::next(TraceRecord &record) {
+    uint64_t head, id;
+    if (!valid || !get(head) || !get(id) || (head & 7) >= TraceEventCount) {
+        return false;
+    }
+    uint32_t zigzag = (uint32_t) (head >> 3);
+    time += (int) (zigzag >> 1 ^ -(zigzag & 1));
+    record.time = time;
+    record.event = (TraceEvent) (head & 7);
+    record.id = (int) id - 1;
+    return true;
+}
+
+bool TraceReader::get(uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = getc(file);
+        if (byte == EOF) {
+            return false;
+        }
+        value |= (uint64_t) (byte & 0x7f) << shift;
+        if (byte < 0x80) {
+            return true;
+        }
+    }
+    return false;
+}
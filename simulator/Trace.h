@@ -0,0 +1,123 @@
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef SIMULATOR_TRACE_H
+#define SIMULATOR_TRACE_H
+
+// Schedulers only record traces when built with SIMULATOR_TRACE, otherwise
+// every TRACE(...) statement compiles to nothing and setTrace has no effect.
+#ifdef SIMULATOR_TRACE
+#define TRACE(statement) statement
+#else
+#define TRACE(statement)
+#endif
+
+// What a scheduler did to a task. Miss is any job that failed: past its
+// deadline, past its budget, or dropped. ModeSwitch is recorded for the task
+// that overran, and for task -1 on the return to low mode.
+enum TraceEvent { TraceRelease, TraceDispatch, TracePreempt, TraceComplete, TraceMiss, TraceDrop, TraceModeSwitch,
+                  TraceEventCount };
+
+const char *const TRACE_EVENT_NAMES[TraceEventCount] = {"release", "dispatch", "preempt", "complete", "miss", "drop",
+                                                        "mode-switch"};
+
+struct TraceRecord {
+    int time;
+    TraceEvent event;
+    int id;
+};
+
+// Writes the events of one run to a file, in the order they are recorded.
+// The file starts with TRACE_MAGIC and the scheduler's name, each record is
+// then two varints: the zigzagged time since the previous record shifted
+// left by three with the event in the low bits, and the task id plus one.
+// Records fill a buffer that a thread of its own writes out while the next one
+// fills.
+class TraceWriter {
+public:
+    TraceWriter(const std::string &fileName, const std::string &scheduler);
+    ~TraceWriter();
+    bool good() const;
+
+    // The time of the events recorded next.
+    void setTime(int time);
+    void record(TraceEvent event, int id);
+    // Writes out what is buffered and closes the file.
+    void close();
+
+private:
+    static const size_t BUFFER_SIZE = 1 << 20;
+    // The most a record can take.
+    static const size_t RECORD_SIZE = 15;
+
+    void put(uint64_t value);
+    void flush();
+    void writeLoop();
+
+    FILE *file = nullptr;
+    int time = 0;
+    int lastTime = 0;
+    std::vector<uint8_t> buffer;
+    size_t used = 0;
+
+    // The buffer handed to the writing thread, if full.
+    std::vector<uint8_t> pending;
+    bool hasPending = false;
+    bool closing = false;
+    std::mutex lock;
+    std::condition_variable changed;
+    std::thread writer;
+};
+
+// Reads back a file written by TraceWriter.
+class TraceReader {
+public:
+    explicit TraceReader(const std::string &fileName);
+    ~TraceReader();
+    // Whether the file opened and started like a trace.
+    bool good() const;
+    const std::string &getScheduler() const;
+    // Reads the next record, false at the end of the file or on a truncated
+    // record.
+    bool next(TraceRecord &record);
+
+private:
+    bool get(uint64_t &value);
+
+    FILE *file = nullptr;
+    bool valid = false;
+    std::string scheduler;
+    int time = 0;
+};
+
+const char TRACE_MAGIC[8] = {'S', 'C', 'H', 'T', 'R', 'A', 'C', '1'};
+
+inline void TraceWriter::setTime(int timeIn) {
+    time = timeIn;
+}
+
+inline void TraceWriter::record(TraceEvent event, int id) {
+    if (used + RECORD_SIZE > BUFFER_SIZE) {
+        flush();
+    }
+    int delta = time - lastTime;
+    lastTime = time;
+    uint32_t zigzag = (uint32_t) delta << 1 ^ (uint32_t) (delta >> 31);
+    put((uint64_t) zigzag << 3 | event);
+    put((uint32_t) (id + 1));
+}
+
+inline void TraceWriter::put(uint64_t value) {
+    while (value >= 0x80) {
+        buffer[used++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    buffer[used++] = (uint8_t) value;
+}
+
+#endif //SIMULATOR_TRACE_H
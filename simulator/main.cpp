@@ -1,91 +1,265 @@
+#include <ctime>
 #include <iostream>
 #include <fstream>
+#include <thread>
 
-#include <sstream>
-#include "Scheduler.h"
+#include "Args.h"
+#include "Experiment.h"
+#include "Sweep.h"
 
 using namespace std;
 
+// simulator sweep [name=value,...] [threads=n] [out=file]
+// Sweeps generation parameters in memory instead of reading tasks/, see
+// parseSweepArg for the names.
+int sweepMain(int argc, char* argv[]) {
+    SweepGrid grid;
+    grid.seed = (uint64_t) time(0);
+    int threadNum = thread::hardware_concurrency();
+    string outName = "sweep.csv";
 
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 8, "threads=") == 0) {
+            threadNum = atoi(arg.c_str() + 8);
+        } else if (arg.compare(0, 4, "out=") == 0) {
+            outName = arg.substr(4);
+        } else if (!parseSweepArg(arg, grid)) {
+            cerr << "Bad sweep argument " << arg << '\n';
+            return 1;
+        }
+    }
+    if (threadNum < 1) {
+        threadNum = 1;
+    }
 
-int main() {
-    float bound, overrunP, slackRatio;
-    int clockPeriods, taskSetNum, numTasks;
-
-    taskSetNum = 1;
+    cout << "seed " << grid.seed << '\n';
+    ofstream out(outName);
+    runSweep(grid, threadNum, out);
+    return 0;
+}
 
-    vector<Scheduler*> schedulers;
-    schedulers.push_back(new H_FMC());
-    schedulers.push_back(new EDF());
-    schedulers.push_back(new EDFVD());
-    schedulers.push_back(new FMC());
-    schedulers.push_back(new FMC_Drop());
-    schedulers.push_back(new RED());
+// simulator fork [set=n] [warmup=t] [quanta=q,...] [save=prefix] [resume=prefix]
+//                [skeleton=1]
+// Runs every scheduler on tasks/task_set_n with quantum 100 up to warmup, then
+// forks the run into one per quantum, each going on to the end of the set.
+// save writes the warm state of each scheduler to prefix<scheduler>.snap,
+// resume starts from such files instead of warming up. skeleton also forks
+// SKELETON.
+int forkMain(int argc, char* argv[]) {
+    int setNum = 0;
+    int warmup = 1000000;
+    vector<int> quanta{100};
+    string savePrefix, resumePrefix;
+    bool skeleton = false;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string name = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        bool ok;
+        if (name == "set") {
+            ok = parseValue(value, setNum);
+        } else if (name == "warmup") {
+            ok = parseValue(value, warmup);
+        } else if (name == "quanta") {
+            ok = parseList(value, quanta);
+        } else if (name == "save") {
+            savePrefix = value;
+            ok = !value.empty();
+        } else if (name == "resume") {
+            resumePrefix = value;
+            ok = !value.empty();
+        } else if (name == "skeleton") {
+            ok = parseValue(value, skeleton);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            cerr << "Bad fork argument " << arg << '\n';
+            return 1;
+        }
+    }
 
-    vector<float> lowPFJ(schedulers.size(), 0.0f);
-    vector<float> highPFJ(schedulers.size(), 0.0f);
-    vector<float> switchRatios(schedulers.size(), 0.0f);
+    TaskSet taskSet;
+    if (!taskSet.load("tasks/task_set_" + to_string(setNum))) {
+        cerr << "Could not read task set " << setNum << '\n';
+        return 1;
+    }
 
-    ofstream myfile;
-    myfile.open("output.txt");
+    vector<Scheduler*> schedulers = makeSchedulers(1, FirstFit, 1, skeleton);
+    for (int i = 0; i < schedulers.size(); i++) {
+        Scheduler* warm = schedulers[i];
+        string fileName = warm->getName() + ".snap";
+        Snapshot snapshot;
+        if (!resumePrefix.empty()) {
+            if (!snapshot.read(resumePrefix + fileName)) {
+                cerr << "Could not read " << resumePrefix + fileName << '\n';
+                return 1;
+            }
+        } else {
+            warm->reset(taskSet.tasks);
+            int time = warm->begin(100, taskSet.clockPeriods);
+            while (time <= warmup && time <= taskSet.clockPeriods) {
+                time = warm->step(time);
+            }
+            warm->save(snapshot, time);
+            if (!savePrefix.empty() && !snapshot.write(savePrefix + fileName)) {
+                cerr << "Could not write " << savePrefix + fileName << '\n';
+                return 1;
+            }
+        }
 
-    for (int fileNum = 0; fileNum < taskSetNum; fileNum++) {
-        ifstream file;
-        file.open("tasks/task_set_" + to_string(fileNum) + ".txt");
-        file >> bound >> overrunP >> slackRatio >> clockPeriods >> taskSetNum >> numTasks;
-        //if (fileNum == 0) continue;
+        for (int quantum : quanta) {
+            vector<Scheduler*> forks = makeSchedulers(1, FirstFit, 1, skeleton);
+            Scheduler* sch = forks[i];
+            sch->reset(taskSet.tasks);
+            snapshot.rewind();
+            int time = sch->resume(snapshot, quantum, taskSet.clockPeriods);
+            if (time < 0) {
+                cerr << "Could not resume " << sch->getName() << '\n';
+                return 1;
+            }
+            while (time <= taskSet.clockPeriods) {
+                time = sch->step(time);
+            }
+            sch->finish();
+            cout << sch->getName() << " quantum " << quantum << ":\tLow PFJ: " << sch->getLowPFJ()
+                 << ",  High PFJ: " << sch->getHighPFJ() << ",  Switches: " << sch->getContextSwitches() << '\n';
+            for (Scheduler* fork : forks) {
+                delete fork;
+            }
+        }
+    }
+    for (Scheduler* sch : schedulers) {
+        delete sch;
+    }
+    return 0;
+}
 
-        vector<Task> tasks;
+// simulator [threads] [precision=p] [jobs=n] [cores=m] [packing=first|worst|criticality]
+//           [skeleton=1] [analysis=off|flag|skip]
+// Runs every scheduler on tasks/, each run stopping early once its PFJs are
+// within p or after n jobs if given, see Scheduler::scheduleConverged, and
+// partitioned onto m cores if given, see Partition.h. skeleton adds SKELETON
+// on one core. analysis adds each set's verdicts to its results, and with
+// skip leaves the sets a scheduler fails out of its totals, see AnalysisMode.
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "sweep") {
+        return sweepMain(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "fork") {
+        return forkMain(argc, argv);
+    }
 
-        string line;
-        getline(file, line);
+    int threadNum = thread::hardware_concurrency();
+    RunOptions options;
+    AnalysisMode analysis = AnalysisOff;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        bool ok;
+        if (eq == string::npos) {
+            ok = parseValue(arg, threadNum);
+        } else if (arg.compare(0, eq, "precision") == 0) {
+            ok = parseValue(arg.substr(eq + 1), options.precision);
+        } else if (arg.compare(0, eq, "jobs") == 0) {
+            ok = parseValue(arg.substr(eq + 1), options.jobBudget);
+        } else if (arg.compare(0, eq, "cores") == 0) {
+            ok = parseValue(arg.substr(eq + 1), options.cores) && options.cores >= 1;
+        } else if (arg.compare(0, eq, "packing") == 0) {
+            ok = parsePacking(arg.substr(eq + 1), options.packing);
+        } else if (arg.compare(0, eq, "skeleton") == 0) {
+            ok = parseValue(arg.substr(eq + 1), options.skeleton);
+        } else if (arg.compare(0, eq, "analysis") == 0) {
+            ok = parseAnalysisMode(arg.substr(eq + 1), analysis);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            cerr << "Bad argument " << arg << '\n';
+            return 1;
+        }
+    }
+    bool early = options.precision > 0 || options.jobBudget > 0;
+    if (threadNum < 1) {
+        threadNum = 1;
+    }
 
-        for (int i = 0; i < numTasks; i++) {
-            getline(file, line);
+    vector<unique_ptr<TaskSet>> taskSets;
+    int taskSetNum = 1;
+    for (int fileNum = 0; fileNum < taskSetNum; fileNum++) {
+        unique_ptr<TaskSet> taskSet(new TaskSet());
+        if (!taskSet->load("tasks/task_set_" + to_string(fileNum))) {
+            cerr << "Could not read task set " << fileNum << '\n';
+            return 1;
+        }
+        taskSetNum = taskSet->taskSetNum;
+        taskSets.push_back(move(taskSet));
+    }
 
-            istringstream iss(line);
+    vector<Scheduler*> schedulers = makeSchedulers(options.cores, options.packing, 1, options.skeleton);
+    vector<vector<Verdict>> verdicts;
+    vector<vector<bool>> excluded, skip;
+    analyzeSets(taskSets, schedulers, analysis, verdicts, excluded, skip);
+    vector<vector<Result>> results;
+    runAll(taskSets, schedulers.size(), threadNum, results, skip, options);
 
-            Task t;
+    vector<float> lowPFJ(schedulers.size(), 0.0f);
+    vector<float> highPFJ(schedulers.size(), 0.0f);
+    vector<float> switchRatios(schedulers.size(), 0.0f);
+    // The sets each scheduler's totals are over.
+    vector<int> counted(schedulers.size(), 0);
 
-            char crit;
-            iss >> t.period >> crit >> t.lowC >> t.highC;
-            t.crit = crit == 'L' ? Low : High;
-            while (!iss.eof()) {
-                int val;
-                iss >> val;
-                t.exeTimes.push_back(val);
-            }
-            tasks.push_back(t);
-        }
+    ofstream myfile;
+    myfile.open("output.txt");
 
+    for (int fileNum = 0; fileNum < taskSetNum; fileNum++) {
         myfile << "********************** TEST CASE: " << fileNum << " *************************\n";
         cout << "********************** TEST CASE: " << fileNum << " *************************\n";
-        int switches = -1;
         for (int i = 0; i < schedulers.size(); i++) {
-            Scheduler* sch = schedulers[i];
-            sch->reset(tasks);
-            sch->schedule(100, clockPeriods);
-            lowPFJ[i] += sch->getLowPFJ();
-            highPFJ[i] += sch->getHighPFJ();
-            if (switches == -1) {
-                switches = sch->getContextSwitches();
+            if (!excluded.empty() && excluded[fileNum][i]) {
+                myfile << schedulers[i]->getName() << ":\tLeft out, analysis fails\n";
+                continue;
             }
-            switchRatios[i] += (float) sch->getContextSwitches() / (float) switches;
-            myfile << sch->getName() << ":\tLow PFJ: " << sch->getLowPFJ() << ",  High PFJ: " << sch->getHighPFJ() << ",  Switches: " << sch->getContextSwitches() << '\n';
+            const Result &r = results[fileNum][i];
+            lowPFJ[i] += r.lowPFJ;
+            highPFJ[i] += r.highPFJ;
+            switchRatios[i] += (float) switchRatio(r, results[fileNum][0]);
+            counted[i]++;
+            myfile << schedulers[i]->getName() << ":\tLow PFJ: " << r.lowPFJ << ",  High PFJ: " << r.highPFJ << ",  Switches: " << r.switches;
+            if (!verdicts.empty() && verdicts[fileNum][i] != Unanalyzed) {
+                myfile << ",  Analysis: " << (verdicts[fileNum][i] == Passes ? "passes" : "fails");
+            }
+            if (early) {
+                myfile << ",  Low CI: " << r.lowHalfWidth << ",  High CI: " << r.highHalfWidth << ",  Ticks: " << r.ticks;
+            }
+            if (!r.coreUtilizations.empty()) {
+                myfile << ",  Migrations: " << r.migrations << ",  Core utilizations:";
+                for (float u : r.coreUtilizations) {
+                    myfile << ' ' << u;
+                }
+            }
+            myfile << '\n';
         }
-        /*Scheduler* sch = new FMC_Drop(tasks);
-        sch->schedule(1, clockPeriods);
-        cout << "Low PFJ: " << sch->getLowPFJ() << ",  High PFJ: " << sch->getHighPFJ() << ",  Switches: " << sch->getContextSwitches() << '\n';*/
-
-        tasks.clear();
     }
 
-    myfile << bound << " " << overrunP << " " << slackRatio << " " << clockPeriods << '\n';
+    const TaskSet &last = *taskSets.back();
+    myfile << last.bound << " " << last.overrunP << " " << last.slackRatio << " " << last.clockPeriods << '\n';
+    myfile << "Utilization bits: " << SIMULATOR_UTIL_BITS << '\n';
 
     myfile << "********************** TOTALS: *************************\n";
 
     for (int i = 0; i < lowPFJ.size(); i++) {
-        myfile << schedulers[i]->getName() << ":\tLow PFJ: " << lowPFJ[i] / taskSetNum << ",  High PFJ: " << highPFJ[i] / taskSetNum << ",  Switches: " << switchRatios[i] / taskSetNum << '\n';
+        if (counted[i] == 0) {
+            myfile << schedulers[i]->getName() << ":\tLeft out of every set\n";
+            continue;
+        }
+        myfile << schedulers[i]->getName() << ":\tLow PFJ: " << lowPFJ[i] / counted[i] << ",  High PFJ: " << highPFJ[i] / counted[i] << ",  Switches: " << switchRatios[i] / counted[i];
+        if (counted[i] < taskSetNum) {
+            myfile << ",  Sets: " << counted[i];
+        }
+        myfile << '\n';
     }
 
     for (Scheduler* sch : schedulers) {
@@ -0,0 +1,270 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+#include "Args.h"
+#include "Batch.h"
+#include "Experiment.h"
+#include "TaskGen.h"
+#include "TaskSet.h"
+
+using namespace std;
+
+// Identifies one measurement, rows of a baseline are matched on it.
+typedef tuple<string, int, float, float, int> BenchKey;
+
+map<BenchKey, double> readBaseline(const string &fileName) {
+    map<BenchKey, double> baseline;
+    ifstream file(fileName);
+    string line;
+    getline(file, line);
+    while (getline(file, line)) {
+        istringstream iss(line);
+        vector<string> fields;
+        string field;
+        while (getline(iss, field, ',')) {
+            fields.push_back(field);
+        }
+        if (fields.size() < 9) {
+            continue;
+        }
+        BenchKey key(fields[0], stoi(fields[1]), stof(fields[2]), stof(fields[3]), stoi(fields[4]));
+        baseline[key] = stod(fields[8]);
+    }
+    return baseline;
+}
+
+#ifdef SIMULATOR_STATS
+// Prints what the last run of a scheduler spent its decisions and time on.
+void printStats(const SchedulerStats &stats) {
+    cout << "  mode switches " << stats.modeSwitches << ", dropped " << stats.dropped << ", re-enabled "
+         << stats.reenabled << ", rejected " << stats.rejected << ", readmitted " << stats.readmitted << '\n';
+    cout << "  seconds";
+    for (int p = 0; p < PhaseCount; p++) {
+        cout << ' ' << PHASE_NAMES[p] << '=' << stats.phaseSeconds[p];
+    }
+    cout << "\n  ready queue length";
+    for (int n = 0; n < stats.readyQueueLength.size(); n++) {
+        if (stats.readyQueueLength[n] > 0) {
+            cout << ' ' << n << ':' << stats.readyQueueLength[n];
+        }
+    }
+    cout << '\n';
+}
+#endif
+
+// Runs sets in one BatchScheduler<Lanes> repeat times, returning the best
+// seconds and setting jobs to the jobs of all lanes.
+template <int Lanes>
+static double timeBatch(bool virtualDeadlines, const vector<const vector<Task>*> &sets, int quantum, int ticks,
+                        int repeat, int &jobs) {
+    double best = 0;
+    BatchScheduler<Lanes> batch(virtualDeadlines);
+    vector<int> maxTimes(sets.size(), ticks);
+    for (int r = 0; r < repeat; r++) {
+        auto start = chrono::steady_clock::now();
+        batch.schedule(sets, quantum, maxTimes);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        if (r == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    jobs = 0;
+    for (int l = 0; l < sets.size(); l++) {
+        jobs += batch.getJobs(l);
+    }
+    return best;
+}
+
+// sim_bench [tasks=8,32,1024] [bound=...] [overrunP=...] [quantum=...] [ticks=n]
+//           [repeat=n] [seed=n] [out=file] [baseline=file] [trace=prefix]
+//           [cores=m] [packing=first|worst|criticality] [skeleton=1] [batch=8|16]
+// Measures simulated ticks and jobs per second of every scheduler on one
+// generated task set per grid point, keeping the best of repeat runs. Writes
+// CSV, with the speedup over a previous run's CSV when baseline is given.
+// With cores above 1 every set has cores times the bound, partitioned onto
+// that many cores which schedule runs on threads of their own. skeleton also
+// measures SKELETON on one core. batch also measures BatchScheduler's EDF and
+// EDF-VD on that many sets of each grid point, the first the one the others
+// run, as EDF/8 or EDF-VD/16 with the ticks of all its sets.
+// Built with SIMULATOR_STATS it also prints the statistics of every last run,
+// whose phase timing slows the runs down. Built with SIMULATOR_TRACE and given
+// trace, it records the first run of every scheduler to
+// prefix<scheduler>_<tasks>_<bound>_<overrunP>_<quantum>.trace, see
+// main_trace_dump.cpp.
+int main(int argc, char* argv[]) {
+    vector<int> taskNums{8, 32, 1024};
+    vector<float> bounds{0.9f};
+    vector<float> overrunPs{.5f};
+    vector<int> quanta{100};
+    int ticks = 1000000;
+    int repeat = 3;
+    uint64_t seed = 1;
+    string outName = "bench.csv";
+    string baselineName;
+    string tracePrefix;
+    int cores = 1;
+    bool skeleton = false;
+    int batch = 0;
+    Packing packing = FirstFit;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string name = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        bool ok;
+        if (name == "tasks") {
+            ok = parseList(value, taskNums);
+        } else if (name == "bound") {
+            ok = parseList(value, bounds);
+        } else if (name == "overrunP") {
+            ok = parseList(value, overrunPs);
+        } else if (name == "quantum") {
+            ok = parseList(value, quanta);
+        } else if (name == "ticks") {
+            ok = parseValue(value, ticks);
+        } else if (name == "repeat") {
+            ok = parseValue(value, repeat);
+        } else if (name == "seed") {
+            ok = parseValue(value, seed);
+        } else if (name == "skeleton") {
+            ok = parseValue(value, skeleton);
+        } else if (name == "batch") {
+            ok = parseValue(value, batch) && (batch == 0 || batch == 8 || batch == 16);
+        } else if (name == "cores") {
+            ok = parseValue(value, cores) && cores >= 1;
+        } else if (name == "packing") {
+            ok = parsePacking(value, packing);
+        } else if (name == "out") {
+            outName = value;
+            ok = !value.empty();
+        } else if (name == "baseline") {
+            baselineName = value;
+            ok = !value.empty();
+        } else if (name == "trace") {
+            tracePrefix = value;
+#ifdef SIMULATOR_TRACE
+            ok = !value.empty();
+#else
+            cerr << "trace needs a build with SIMULATOR_TRACE\n";
+            ok = false;
+#endif
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            cerr << "Bad argument " << arg << '\n';
+            return 1;
+        }
+    }
+
+    map<BenchKey, double> baseline;
+    if (!baselineName.empty()) {
+        baseline = readBaseline(baselineName);
+    }
+
+    ofstream out(outName);
+    out << "scheduler,tasks,bound,overrunP,quantum,ticks,jobs,seconds,ticksPerSecond,jobsPerSecond";
+    if (!baselineName.empty()) {
+        out << ",baselineTicksPerSecond,speedup";
+    }
+    out << '\n';
+
+    vector<Scheduler*> schedulers = makeSchedulers(cores, packing, cores, skeleton);
+    for (int taskNum : taskNums) {
+        for (float bound : bounds) {
+            for (float overrunP : overrunPs) {
+                GenParams params;
+                params.bound = bound * cores;
+                params.overrunP = overrunP;
+                params.clockPeriods = ticks;
+                TaskSet taskSet;
+                generateTaskSet(params, taskNum, seed, 0, taskSet);
+
+                auto report = [&](const string &name, int quantum, long long ranTicks, int jobs, double best) {
+                    double ticksPerSecond = (double) ranTicks / best;
+                    out << name << ',' << taskNum << ',' << bound << ',' << overrunP << ',' << quantum << ','
+                        << ranTicks << ',' << jobs << ',' << best << ',' << ticksPerSecond << ',' << jobs / best;
+                    if (!baselineName.empty()) {
+                        ostringstream boundText, overrunText;
+                        boundText << bound;
+                        overrunText << overrunP;
+                        auto it = baseline.find(BenchKey(name, taskNum, stof(boundText.str()),
+                                                         stof(overrunText.str()), quantum));
+                        if (it != baseline.end()) {
+                            out << ',' << it->second << ',' << ticksPerSecond / it->second;
+                        } else {
+                            out << ",,";
+                        }
+                    }
+                    out << '\n';
+                    cout << name << " tasks=" << taskNum << " bound=" << bound << " overrunP=" << overrunP
+                         << " quantum=" << quantum << ": " << ticksPerSecond << " ticks/s\n";
+                };
+
+                vector<TaskSet> batchSets(max(batch - 1, 0));
+                vector<const vector<Task>*> lanes;
+                if (batch > 0) {
+                    lanes.push_back(&taskSet.tasks);
+                    for (int l = 1; l < batch; l++) {
+                        generateTaskSet(params, taskNum, seed, l, batchSets[l - 1]);
+                        lanes.push_back(&batchSets[l - 1].tasks);
+                    }
+                }
+
+                for (int quantum : quanta) {
+                    for (int i = 0; i < schedulers.size(); i++) {
+                        Scheduler* sch = schedulers[i];
+                        double best = 0;
+                        for (int r = 0; r < repeat; r++) {
+                            sch->reset(taskSet.tasks);
+                            unique_ptr<TraceWriter> trace;
+                            if (r == 0 && !tracePrefix.empty()) {
+                                ostringstream traceName;
+                                traceName << tracePrefix << sch->getName() << '_' << taskNum << '_' << bound << '_'
+                                          << overrunP << '_' << quantum << ".trace";
+                                trace.reset(new TraceWriter(traceName.str(), sch->getName()));
+                                if (!trace->good()) {
+                                    cerr << "Could not write " << traceName.str() << '\n';
+                                    return 1;
+                                }
+                                sch->setTrace(trace.get());
+                            }
+                            auto start = chrono::steady_clock::now();
+                            sch->schedule(quantum, ticks);
+                            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+                            sch->setTrace(nullptr);
+                            if (r == 0 || elapsed.count() < best) {
+                                best = elapsed.count();
+                            }
+                        }
+                        report(sch->getName(), quantum, ticks, sch->getJobs(), best);
+#ifdef SIMULATOR_STATS
+                        printStats(sch->getStats());
+#endif
+                    }
+                    for (bool virtualDeadlines : {false, true}) {
+                        if (batch > 0) {
+                            int jobs;
+                            double best = batch == 8
+                                    ? timeBatch<8>(virtualDeadlines, lanes, quantum, ticks, repeat, jobs)
+                                    : timeBatch<16>(virtualDeadlines, lanes, quantum, ticks, repeat, jobs);
+                            ostringstream name;
+                            name << (virtualDeadlines ? "EDF-VD/" : "EDF/") << batch;
+                            report(name.str(), quantum, (long long) ticks * batch, jobs, best);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (Scheduler* sch : schedulers) {
+        delete sch;
+    }
+    return 0;
+}
@@ -0,0 +1,531 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Analysis.h"
+#include "Args.h"
+#include "Batch.h"
+#include "DeadlineHeap.h"
+#include "DemandTree.h"
+#include "EdfEngine.h"
+#include "Scheduler.h"
+#include "TaskGen.h"
+#include "TaskSet.h"
+#include "TaskTable.h"
+#include "TimerWheel.h"
+#include "Utilization.h"
+
+using namespace std;
+
+// RED's ready queue as the baseline kept it: a list in deadline order, later
+// insertions behind equal deadlines, scanned from the front for every query.
+struct DemandList {
+    struct Entry {
+        int id;
+        int deadline;
+        int demand;
+        int limit;
+        bool low;
+    };
+    vector<Entry> entries;
+
+    void insert(int id, int deadline, int demand, int limit, bool low) {
+        int pos = 0;
+        while (pos < entries.size() && entries[pos].deadline <= deadline) {
+            pos++;
+        }
+        entries.insert(entries.begin() + pos, Entry{id, deadline, demand, limit, low});
+    }
+
+    void erase(int id) {
+        entries.erase(entries.begin() + find(id));
+    }
+
+    int find(int id) const {
+        for (int pos = 0; pos < entries.size(); pos++) {
+            if (entries[pos].id == id) {
+                return pos;
+            }
+        }
+        return -1;
+    }
+
+    int front() const {
+        return entries.empty() ? -1 : entries[0].id;
+    }
+
+    int firstOverloaded() const {
+        int sum = 0;
+        for (const Entry &e : entries) {
+            sum += e.demand;
+            if (sum > e.limit) {
+                return e.id;
+            }
+        }
+        return -1;
+    }
+
+    int lastLowBefore(int id) const {
+        int found = -1;
+        for (int pos = 0; pos < find(id); pos++) {
+            if (entries[pos].low) {
+                found = entries[pos].id;
+            }
+        }
+        return found;
+    }
+};
+
+static bool fail(const string &what, int round) {
+    cerr << what << " differs in round " << round << '\n';
+    return false;
+}
+
+// Random inserts and erases on a few tasks with many equal deadlines, after
+// each of which every query must agree, and a snapshot must restore the tree.
+static bool checkDemandTree(mt19937 &random, int rounds) {
+    for (int round = 0; round < rounds; round++) {
+        int size = 1 + (int) (random() % 40);
+        DemandTree tree;
+        tree.reset(size);
+        DemandList list;
+        for (int op = 0; op < 400; op++) {
+            int id = (int) (random() % size);
+            if (tree.contains(id) != (list.find(id) >= 0)) {
+                return fail("DemandTree contains", round);
+            }
+            if (tree.contains(id)) {
+                tree.erase(id);
+                list.erase(id);
+            } else {
+                int deadline = (int) (random() % 50);
+                int demand = (int) (random() % 20);
+                int limit = (int) (random() % 100);
+                bool low = random() % 2 == 0;
+                tree.insert(id, deadline, demand, limit, low);
+                list.insert(id, deadline, demand, limit, low);
+            }
+            if (op % 50 == 0) {
+                Snapshot snapshot;
+                tree.save(snapshot);
+                tree = DemandTree();
+                tree.load(snapshot);
+            }
+            if (tree.size() != list.entries.size() || tree.empty() != list.entries.empty()) {
+                return fail("DemandTree size", round);
+            }
+            if (tree.front() != list.front()) {
+                return fail("DemandTree front", round);
+            }
+            if (tree.firstOverloaded() != list.firstOverloaded()) {
+                return fail("DemandTree firstOverloaded", round);
+            }
+            for (const DemandList::Entry &e : list.entries) {
+                if (tree.lastLowBefore(e.id) != list.lastLowBefore(e.id)) {
+                    return fail("DemandTree lastLowBefore", round);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// The EDF family's baseline pick: a scan over the ready tasks for the earliest
+// deadline, the lower id on ties. -1 marks a task that is not ready.
+static int earliest(const vector<int> &deadlines) {
+    int best = -1;
+    for (int id = 0; id < deadlines.size(); id++) {
+        if (deadlines[id] >= 0 && (best < 0 || deadlines[id] < deadlines[best])) {
+            best = id;
+        }
+    }
+    return best;
+}
+
+// Random pushes, pops, erases, updates and bulk re-keys, after each of which
+// the heap's top, size and keys must agree with the scan.
+static bool checkDeadlineHeap(mt19937 &random, int rounds) {
+    for (int round = 0; round < rounds; round++) {
+        int size = 1 + (int) (random() % 70);
+        DeadlineHeap heap;
+        heap.reset(size);
+        vector<int> deadlines(size, -1);
+        int ready = 0;
+        for (int op = 0; op < 400; op++) {
+            int id = (int) (random() % size);
+            int deadline = (int) (random() % 60);
+            switch (random() % 5) {
+                case 0:
+                    if (deadlines[id] < 0) {
+                        heap.push(id, deadline);
+                        deadlines[id] = deadline;
+                        ready++;
+                    }
+                    break;
+                case 1:
+                    if (ready > 0) {
+                        int top = earliest(deadlines);
+                        if (heap.pop() != top) {
+                            return fail("DeadlineHeap pop", round);
+                        }
+                        deadlines[top] = -1;
+                        ready--;
+                    }
+                    break;
+                case 2:
+                    heap.erase(id);
+                    if (deadlines[id] >= 0) {
+                        deadlines[id] = -1;
+                        ready--;
+                    }
+                    break;
+                case 3:
+                    if (deadlines[id] >= 0) {
+                        heap.update(id, deadline);
+                        deadlines[id] = deadline;
+                    }
+                    break;
+                default:
+                    for (int other = 0; other < size; other++) {
+                        if (deadlines[other] >= 0 && random() % 3 == 0) {
+                            deadlines[other] = (int) (random() % 60);
+                            heap.setDeadline(other, deadlines[other]);
+                        }
+                    }
+                    heap.rebuild();
+                    break;
+            }
+            if (op % 50 == 0) {
+                Snapshot snapshot;
+                heap.save(snapshot);
+                heap = DeadlineHeap();
+                heap.load(snapshot);
+            }
+            if (heap.size() != ready || heap.empty() != (ready == 0)) {
+                return fail("DeadlineHeap size", round);
+            }
+            if (ready > 0 && (heap.top() != earliest(deadlines) ||
+                              heap.topDeadline() != deadlines[earliest(deadlines)])) {
+                return fail("DeadlineHeap top", round);
+            }
+            for (int other = 0; other < size; other++) {
+                if (heap.contains(other) != (deadlines[other] >= 0) ||
+                    (deadlines[other] >= 0 && heap.deadline(other) != deadlines[other])) {
+                    return fail("DeadlineHeap contains", round);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Random adds and advances over every level of the wheel, timers at or before
+// now included. Each advance must fire exactly the timers a scan of the ones
+// added finds due, and earliest must be their minimum.
+static bool checkTimerWheel(mt19937 &random, int rounds) {
+    for (int round = 0; round < rounds; round++) {
+        TimerWheel wheel;
+        int now = (int) (random() % 1000);
+        wheel.reset(now);
+        vector<pair<int, int>> pending;
+        vector<int> fired, expected;
+        for (int op = 0; op < 400; op++) {
+            if (random() % 3 != 0) {
+                int scale = 1 << 4 * (int) (random() % 7);
+                int time = now - 5 + (int) (random() % scale);
+                wheel.add(time, op);
+                pending.emplace_back(time, op);
+            } else {
+                int scale = 1 << 3 * (int) (random() % 8);
+                now += (int) (random() % scale);
+                fired.clear();
+                wheel.advance(now, [&](int value) {
+                    fired.push_back(value);
+                });
+                expected.clear();
+                for (int i = 0; i < pending.size(); i++) {
+                    if (pending[i].first <= now) {
+                        expected.push_back(pending[i].second);
+                        pending[i--] = pending.back();
+                        pending.pop_back();
+                    }
+                }
+                sort(fired.begin(), fired.end());
+                sort(expected.begin(), expected.end());
+                if (fired != expected) {
+                    return fail("TimerWheel advance", round);
+                }
+            }
+            if (op % 50 == 0) {
+                Snapshot snapshot;
+                wheel.save(snapshot);
+                wheel = TimerWheel();
+                wheel.load(snapshot);
+            }
+            if (wheel.empty() != pending.empty()) {
+                return fail("TimerWheel empty", round);
+            }
+            int first = INT32_MAX;
+            for (const pair<int, int> &timer : pending) {
+                first = min(first, timer.first);
+            }
+            if (!pending.empty() && wheel.earliest() != first) {
+                return fail("TimerWheel earliest", round);
+            }
+        }
+    }
+    return true;
+}
+
+// Tasks going idle and waking at random. After every advance the table's due
+// and late sets must be the baseline's per-tick scans: idle tasks at or past
+// their wakeup, and the others past their deadline.
+static bool checkTaskTable(mt19937 &random, int rounds) {
+    for (int round = 0; round < rounds; round++) {
+        int size = 1 + (int) (random() % 150);
+        TaskTable table;
+        table.reset(size);
+        TaskMask idle;
+        idle.reset(size);
+        idle.fill();
+        int time = 0;
+        for (int id = 0; id < size; id++) {
+            table.wakeupTime[id] = (int) (random() % 200);
+            table.sleep(id);
+        }
+        for (int op = 0; op < 300; op++) {
+            time += (int) (random() % 40);
+            table.advance(time, idle);
+            for (int id = 0; id < size; id++) {
+                bool due = idle.contains(id) && time >= table.wakeupTime[id];
+                bool late = !idle.contains(id) && time > table.absoluteDeadline[id];
+                if (table.due().contains(id) != due || table.late().contains(id) != late) {
+                    return fail("TaskTable due or late", round);
+                }
+            }
+            for (int n = (int) (random() % 8); n > 0; n--) {
+                int id = (int) (random() % size);
+                if (idle.contains(id)) {
+                    table.absoluteDeadline[id] = time + (int) (random() % 300);
+                    idle.erase(id);
+                    table.wake(id);
+                } else {
+                    table.wakeupTime[id] = time + (int) (random() % 300);
+                    idle.insert(id);
+                    table.sleep(id);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// The processor demand criterion checked the long way: utilization at most 1
+// and demand at most t at every t up to a hyperperiod past the last deadline,
+// after which the demand repeats.
+static bool demandFits(const vector<DemandTask> &tasks) {
+    long long work = 0;
+    long long hyper = 1;
+    long long dMax = 0;
+    for (const DemandTask &task : tasks) {
+        long long a = hyper, b = task.t;
+        while (b != 0) {
+            a %= b;
+            swap(a, b);
+        }
+        hyper = hyper / a * task.t;
+        dMax = max(dMax, task.d);
+    }
+    for (const DemandTask &task : tasks) {
+        work += hyper / task.t * task.c;
+    }
+    if (work > hyper) {
+        return false;
+    }
+    for (long long t = 1; t <= hyper + dMax; t++) {
+        long long h = 0;
+        for (const DemandTask &task : tasks) {
+            if (task.d <= t) {
+                h += ((t - task.d) / task.t + 1) * task.c;
+            }
+        }
+        if (h > t) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Small random task sets near full utilization, deadlines before, at and
+// past the period, on which QPA must agree with the scan.
+static bool checkQpa(mt19937 &random, int rounds) {
+    for (int round = 0; round < rounds * 10; round++) {
+        vector<DemandTask> tasks;
+        for (int n = 1 + (int) (random() % 5); n > 0; n--) {
+            long long t = 2 + (long long) (random() % 30);
+            long long c = 1 + (long long) (random() % (t / 2));
+            long long d = 1 + (long long) (random() % (2 * t));
+            tasks.push_back(DemandTask{c, d, t});
+        }
+        if (qpaSchedulable(tasks) != demandFits(tasks)) {
+            return fail("qpaSchedulable", round);
+        }
+    }
+    return true;
+}
+
+// Utilizations past the saturated value stay saturated, and a set whose low
+// tasks use the whole processor, where lamda saturates, runs to sane PFJs on
+// every EDF-based scheduler at once and on a quantum.
+static bool checkSaturation() {
+    Utilization one = Utilization::one();
+    Utilization high = one / Utilization();
+    Utilization low = Utilization() - high;
+    Utilization sum = low;
+    for (int i = 0; i < 4; i++) {
+        sum += low;
+    }
+    if (high * high != high || (one - high) * one != low || sum != low || high + high != high ||
+        low / high >= Utilization() || (one - high) / high <= low) {
+        return fail("Utilization saturation", 0);
+    }
+
+    vector<int> lowTimes(200, 100);
+    vector<int> highTimes(200, 20);
+    for (int job = 0; job < highTimes.size(); job += 2) {
+        highTimes[job] = 60;
+    }
+    vector<Task> tasks{
+            Task{100, Low, 100, 100, ExeTimeSource(lowTimes.data(), lowTimes.size()), Periodic, DelaySource()},
+            Task{200, High, 20, 60, ExeTimeSource(highTimes.data(), highTimes.size()), Periodic, DelaySource()}};
+    for (int quantum : {1, 100}) {
+        vector<unique_ptr<Scheduler>> schedulers;
+        schedulers.emplace_back(new EDFVD(tasks));
+        schedulers.emplace_back(new FMC(tasks));
+        schedulers.emplace_back(new FMC_Drop(tasks));
+        schedulers.emplace_back(new H_FMC(tasks));
+        schedulers.emplace_back(new GlobalEDFVD(1));
+        schedulers.back()->reset(tasks);
+        for (unique_ptr<Scheduler> &sch : schedulers) {
+            sch->schedule(quantum, 10000);
+            float lowPFJ = sch->getLowPFJ();
+            float highPFJ = sch->getHighPFJ();
+            if (sch->getJobs() == 0 || !(lowPFJ >= 0 && lowPFJ <= 1) || !(highPFJ >= 0 && highPFJ <= 1)) {
+                return fail(sch->getName() + " with a low utilization of one", quantum);
+            }
+        }
+        BatchScheduler<8> batch(true);
+        batch.schedule({&tasks}, quantum, {10000});
+        if (batch.getLowPFJ(0) != schedulers[0]->getLowPFJ() || batch.getHighPFJ(0) != schedulers[0]->getHighPFJ()) {
+            return fail("BatchScheduler with a low utilization of one", quantum);
+        }
+    }
+    return true;
+}
+
+// Generated sets, some sporadic, run Lanes at a time with their own run
+// lengths, of which the last batch leaves lanes empty. Every lane must end
+// with the PFJs, switches and jobs of EDF and EDFVD run on its set alone.
+template <int Lanes>
+static bool checkBatch(mt19937 &random, int rounds) {
+    int quanta[] = {1, 7, 100};
+    for (int round = 0; round < rounds / 20 + 1; round++) {
+        GenParams params;
+        params.bound = .5f + (float) (random() % 50) / 100;
+        params.clockPeriods = 20000;
+        params.maxTasks = 12;
+        params.sporadicP = round % 2 == 0 ? 0 : .5f;
+        int quantum = quanta[random() % 3];
+        int setNum = round % 3 == 0 ? Lanes - 3 : Lanes;
+        vector<TaskSet> taskSets(setNum);
+        vector<const vector<Task>*> sets;
+        vector<int> maxTimes;
+        for (int l = 0; l < setNum; l++) {
+            generateTaskSet(params, random(), l, taskSets[l]);
+            sets.push_back(&taskSets[l].tasks);
+            maxTimes.push_back(params.clockPeriods / 2 + (int) (random() % (params.clockPeriods / 2)));
+        }
+
+        for (bool virtualDeadlines : {false, true}) {
+            BatchScheduler<Lanes> batch(virtualDeadlines);
+            batch.schedule(sets, quantum, maxTimes);
+            for (int l = 0; l < setNum; l++) {
+                unique_ptr<Scheduler> sch;
+                if (virtualDeadlines) {
+                    sch.reset(new EDFVD(*sets[l]));
+                } else {
+                    sch.reset(new EDF(*sets[l]));
+                }
+                sch->schedule(quantum, maxTimes[l]);
+                if (batch.getLowPFJ(l) != sch->getLowPFJ() || batch.getHighPFJ(l) != sch->getHighPFJ() ||
+                    batch.getContextSwitches(l) != sch->getContextSwitches() || batch.getJobs(l) != sch->getJobs()) {
+                    return fail(string("BatchScheduler against ") + sch->getName(), round);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// sim_check [seed=n] [rounds=n]
+// Checks the data structures the schedulers are built on against the linear
+// scans they replaced, QPA against the plain demand check and BatchScheduler
+// against EDF and EDFVD, on random inputs, and that saturated utilizations
+// neither overflow nor upset the schedulers. Prints what differed and exits
+// non-zero on the first disagreement.
+int main(int argc, char* argv[]) {
+    unsigned seed = 1;
+    int rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string name = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        bool ok;
+        if (name == "seed") {
+            ok = parseValue(value, seed);
+        } else if (name == "rounds") {
+            ok = parseValue(value, rounds);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            cerr << "Bad argument " << arg << '\n';
+            return 1;
+        }
+    }
+
+    mt19937 random(seed);
+    if (!checkDemandTree(random, rounds)) {
+        return 1;
+    }
+    cout << "DemandTree ok\n";
+    if (!checkDeadlineHeap(random, rounds)) {
+        return 1;
+    }
+    cout << "DeadlineHeap ok\n";
+    if (!checkTimerWheel(random, rounds)) {
+        return 1;
+    }
+    cout << "TimerWheel ok\n";
+    if (!checkTaskTable(random, rounds)) {
+        return 1;
+    }
+    cout << "TaskTable ok\n";
+    if (!checkQpa(random, rounds)) {
+        return 1;
+    }
+    cout << "QPA ok\n";
+    if (!checkSaturation()) {
+        return 1;
+    }
+    cout << "Utilization saturation ok\n";
+    if (!checkBatch<8>(random, rounds) || !checkBatch<16>(random, rounds)) {
+        return 1;
+    }
+    cout << "BatchScheduler ok\n";
+    return 0;
+}
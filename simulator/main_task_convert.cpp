@@ -0,0 +1,28 @@
+#include <iostream>
+
+#include "TaskSet.h"
+
+using namespace std;
+
+// Converts tasks/task_set_<n>.txt into tasks/task_set_<n>.bin for every set
+// named in the first file's header.
+int main(int argc, char *argv[]) {
+    string dir = argc > 1 ? argv[1] : "tasks";
+    int taskSetNum = 1;
+
+    for (int fileNum = 0; fileNum < taskSetNum; fileNum++) {
+        string path = dir + "/task_set_" + to_string(fileNum);
+        TaskSet taskSet;
+        if (!taskSet.loadText(path + ".txt")) {
+            cerr << "Could not read " << path << ".txt\n";
+            return 1;
+        }
+        taskSetNum = taskSet.taskSetNum;
+        if (!taskSet.saveBinary(path + ".bin")) {
+            cerr << "Could not write " << path << ".bin\n";
+            return 1;
+        }
+        cout << path << ".bin\n";
+    }
+    return 0;
+}
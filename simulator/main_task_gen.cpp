@@ -1,115 +1,70 @@
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
 #include <iostream>
-#include <fstream>
+#include <thread>
 #include <vector>
-#include <filesystem>
-#include <cmath>
 
-using namespace std;
+#include "TaskGen.h"
 
-float randomFloat(float min, float max) {
-    if (abs (max - min) < .000001) {
-        return max;
-    }
-    return ((float)(rand()) / (float)(RAND_MAX)) * (max - min) + min;
-}
+using namespace std;
 
-float randomInt(int min, int max) {
-    if (max == min) {
-        return max;
+// taskGen [seed [threads]]: the same seed always gives the same sets.
+int main(int argc, char* argv[]) {
+    uint64_t seed = argc > 1 ? strtoull(argv[1], nullptr, 10) : (uint64_t) time(0);
+    int threadNum = argc > 2 ? atoi(argv[2]) : (int) thread::hardware_concurrency();
+    if (threadNum < 1) {
+        threadNum = 1;
     }
-    return rand() % (max - min) + min;
-}
-
-enum Criticality { Low, High };
-
-struct Task {
-    int period;
-    Criticality crit;
-    int lowC;
-    int highC;
-};
-
-int main() {
-
-    srand(time(0));
-
-    float bound = 0.9f;
-    float overrunP = .5;
-    float slackRatio = 1;
-
-    float highP = .5;
-
-    int clockPeriods = 10000000;
-    int taskSetNum = 100;
-
-    for (int i = 0; i < taskSetNum; i++) {
-
-        vector<Task> tasks;
-        float utilizationLow = 0.0f;
-        float utilizationHigh = 0.0f;
-
-        while (utilizationLow < bound - .05f && utilizationHigh < bound - .05f) {
-            Task t{};
 
-            float type = randomFloat(0, 1);
-            t.crit = type < highP ? High : Low;
-
-            type = randomFloat(0, 1);
-            float uLow;
-            if (type <= .5f) {
-                t.period = randomInt(200, 1000);
-                uLow = randomFloat(0.05f, .15f);
-            } else if (type <= 1) {
-                t.period = randomInt(1000, 100000);
-                uLow = randomFloat(0.01f, .05f);
-            } else {
-                t.period = randomInt(100000, 10000000);
-                uLow = randomFloat(0.005f, .01f);
-            }
-
-            //t.period = randomInt(200, 1000);
-            //float uLow = randomFloat(0.05f, .15f);
-
-            t.lowC = (int) roundf(uLow * (float) t.period);
-
-            if (t.crit == High) {
-                t.highC = (int) roundf((float) t.lowC * randomFloat(1, 4));
-            } else {
-                t.highC = 0;
-            }
-
-            float uHigh = (float) t.highC / (float) t.period;
-            uLow = (float) t.lowC / (float) t.period;
-            if (uLow + utilizationLow < bound && uHigh + utilizationHigh < bound) {
-                utilizationHigh += uHigh;
-                utilizationLow += uLow;
-                tasks.emplace_back(t);
+    GenParams params;
+    params.bound = 0.9f;
+    params.overrunP = .5;
+    params.slackRatio = 1;
+
+    params.highP = .5;
+    params.sporadicP = 0;
+    params.maxDelay = .5f;
+
+    params.clockPeriods = 10000000;
+    params.taskSetNum = 100;
+
+    // Binary sets are memory mapped by the simulator, text sets are kept for
+    // reading by eye.
+    bool writeBinary = true;
+    // Lazy sets store only a seed and the simulator draws each job's execution
+    // time when it is needed, otherwise the same times are written out.
+    bool lazyExeTimes = true;
+
+    cout << "seed " << seed << '\n';
+
+    atomic<int> next(0);
+    atomic<bool> ok(true);
+    auto worker = [&]() {
+        for (int i = next++; i < params.taskSetNum; i = next++) {
+            TaskSet taskSet;
+            generateTaskSet(params, seed, i, taskSet);
+            taskSet.generated = lazyExeTimes;
+
+            string fileName = "tasks/task_set_" + to_string(i);
+            if (!(writeBinary ? taskSet.saveBinary(fileName + ".bin") : taskSet.saveText(fileName + ".txt"))) {
+                ok = false;
             }
         }
+    };
 
-        if (tasks.size() > 32) {
-            i--;
-            continue;
-        }
-
-        ofstream myfile;
-        myfile.open("tasks/task_set_" + to_string(i) + ".txt");
-
-        myfile << bound << " " << overrunP << " " << slackRatio << " " << clockPeriods << " " << taskSetNum << " " << tasks.size() << '\n';
-
-        for (Task& t : tasks) {
-            myfile << t.period << (t.crit == Low ? " L " : " H ") << t.lowC << " " << t.highC;
-            for (int j = 0; j <= clockPeriods / t.period; j++) {
-                int exTime = randomInt(slackRatio * t.lowC, t.lowC);
-                if (t.crit == High && randomFloat(0, 1) < overrunP) {
-                    exTime = randomInt(max(t.lowC, (int)(slackRatio * t.highC)), t.highC);
-                }
-                myfile << " " << exTime;
-            }
-            myfile << '\n';
-        }
-        myfile.close();
+    vector<thread> threads;
+    for (int i = 1; i < threadNum; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (thread &t : threads) {
+        t.join();
+    }
 
+    if (!ok) {
+        cerr << "Could not write every task set\n";
+        return 1;
     }
     return 0;
 }
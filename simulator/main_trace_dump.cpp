@@ -0,0 +1,120 @@
+#include <deque>
+#include <iostream>
+
+#include "Args.h"
+#include "Trace.h"
+
+using namespace std;
+
+void printRecord(const TraceRecord &record) {
+    cout << record.time << ' ' << TRACE_EVENT_NAMES[record.event] << ' ' << record.id << '\n';
+}
+
+void printCounts(const string &label, const long long counts[TraceEventCount]) {
+    cout << label;
+    for (int e = 0; e < TraceEventCount; e++) {
+        cout << ' ' << TRACE_EVENT_NAMES[e] << '=' << counts[e];
+    }
+    cout << '\n';
+}
+
+int dump(TraceReader &trace) {
+    long long counts[TraceEventCount] = {};
+    TraceRecord record;
+    cout << "# " << trace.getScheduler() << '\n';
+    while (trace.next(record)) {
+        printRecord(record);
+        counts[record.event]++;
+    }
+    printCounts("#", counts);
+    return 0;
+}
+
+// Prints where the two traces first differ, with context records before and
+// after it, and how often each event occurs in each.
+int diff(TraceReader &a, TraceReader &b, int context) {
+    long long countsA[TraceEventCount] = {};
+    long long countsB[TraceEventCount] = {};
+    deque<TraceRecord> before;
+    TraceRecord ra, rb;
+    long long index = 0;
+    bool hasA = a.next(ra);
+    bool hasB = b.next(rb);
+    while (hasA && hasB && ra.time == rb.time && ra.event == rb.event && ra.id == rb.id) {
+        countsA[ra.event]++;
+        countsB[rb.event]++;
+        before.push_back(ra);
+        if (before.size() > context) {
+            before.pop_front();
+        }
+        index++;
+        hasA = a.next(ra);
+        hasB = b.next(rb);
+    }
+    if (!hasA && !hasB) {
+        cout << "identical, " << index << " records\n";
+        return 0;
+    }
+
+    cout << "first difference at record " << index << '\n';
+    for (const TraceRecord &record : before) {
+        cout << "  ";
+        printRecord(record);
+    }
+    for (int side = 0; side < 2; side++) {
+        TraceReader &trace = side == 0 ? a : b;
+        TraceRecord &record = side == 0 ? ra : rb;
+        bool has = side == 0 ? hasA : hasB;
+        long long *counts = side == 0 ? countsA : countsB;
+        cout << (side == 0 ? "< " : "> ") << trace.getScheduler() << '\n';
+        for (int n = 0; has; n++, has = trace.next(record)) {
+            if (n <= context) {
+                cout << (side == 0 ? "< " : "> ");
+                printRecord(record);
+            }
+            counts[record.event]++;
+        }
+    }
+    printCounts("<", countsA);
+    printCounts(">", countsB);
+    return 1;
+}
+
+// traceDump file [other] [context=n]
+// Prints the records of a trace written by a SIMULATOR_TRACE build, one
+// "time event task" line each, or compares two and exits with 1 when they
+// differ.
+int main(int argc, char* argv[]) {
+    vector<string> fileNames;
+    int context = 5;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.compare(0, 8, "context=") == 0) {
+            if (!parseValue(arg.substr(8), context) || context < 0) {
+                cerr << "Bad argument " << arg << '\n';
+                return 2;
+            }
+        } else {
+            fileNames.push_back(arg);
+        }
+    }
+    if (fileNames.empty() || fileNames.size() > 2) {
+        cerr << "Usage: traceDump file [other] [context=n]\n";
+        return 2;
+    }
+
+    TraceReader a(fileNames[0]);
+    if (!a.good()) {
+        cerr << "Could not read trace " << fileNames[0] << '\n';
+        return 2;
+    }
+    if (fileNames.size() == 1) {
+        return dump(a);
+    }
+    TraceReader b(fileNames[1]);
+    if (!b.good()) {
+        cerr << "Could not read trace " << fileNames[1] << '\n';
+        return 2;
+    }
+    return diff(a, b, context);
+}